@@ -5,13 +5,105 @@
  *                                                                         *
  * -v             gives author's name; the program exits immediately after *
  *                the name is printed.                                     *
+ * -V III         check that the maze in file III is well formed and is a  *
+ *                perfect maze, with its entrance and exit open.           *
+ * -i III OOO     measure the maze in file III, placing its dead ends,     *
+ *                junctions, corridors, solution, and diameter in file OOO *
+ *                as JSON.                                                 *
+ * -D III OOO     move the entrance and exit of the maze in file III to    *
+ *                the ends of its longest path, placing it in file OOO.    *
  * -s III OOO     solve the maze in file III placing solution in file OOO. *
+ * -x SSS         solve the maze ( -s) with search SSS, which is one of    *
+ *                bfs, astar, jps, pbfs, or bitboard; all but bfs place    *
+ *                only the path in the solution. If the -x option is not   *
+ *                given, use bfs.                                          *
+ * -p NNN         run the pbfs search ( -x) on NNN threads; if the -p      *
+ *                option is not given, use one thread for each core.       *
+ * -F EEE OOO     also place the exact distance of every cell from the     *
+ *                entrance, found by the solve ( -s) with bfs, in binary   *
+ *                file OOO, written as EEE, which is raw or varint.        *
+ * -w III OOO     solve the weighted maze in file III by cheapest path,    *
+ *                placing only the path in file OOO.                       *
+ * -S III OOO     solve the perfect maze in file III one row at a time,    *
+ *                placing only the path in file OOO.                       *
+ * -R III OOO     solve the maze in file III, placing only its path in     *
+ *                file OOO as runs of moves, such as R12 D3 L4.            *
+ * -M III OOO     solve the maze in file III, placing only its path in     *
+ *                binary file OOO, two bits to a move.                     *
+ * -O MMM PPP     draw the maze in file MMM with the path in file PPP,     *
+ *                written by -R or -M, laid over it.                       *
+ * -q III QQQ OOO answer the queries in file QQQ against the perfect maze  *
+ *                in file III, placing the answers in file OOO. Each query *
+ *                is a line "R1 C1 R2 C2"; each answer is the distance     *
+ *                followed by the row and column of each cell on the path. *
+ * -e III EEE OOO apply the wall edits in file EEE to the maze in file     *
+ *                III, placing the edited maze and its path in file OOO.   *
+ *                Each edit is a line "+ R C W" to add wall W of the cell  *
+ *                at row R and column C, or "- R C W" to remove it.        *
+ * -m III PPP OOO find the nearest source and its distance for every cell  *
+ *                of the maze in file III, placing them in binary file     *
+ *                OOO. File PPP holds lines "S R C" for each source and    *
+ *                "G R C" for each goal; the search stops once every goal  *
+ *                is reached.                                              *
+ * -n III OOO     solve the multi-level maze in file III, placing the maze *
+ *                and the cells on its path in file OOO.                   *
+ * -t III OOO     convert the multi-level maze in file III from text to    *
+ *                binary or from binary to text, placing it in file OOO.   *
+ * -u III OOO     pack the perfect maze in file III into two bits per      *
+ *                cell, placing it in binary file OOO.                     *
+ * -U III OOO     solve the packed maze in file III without unpacking it,  *
+ *                placing the maze and its path in file OOO.               *
+ * -z III OOO     compress the maze in file III into an archive, placing   *
+ *                it in file OOO. Solving ( -s) and drawing ( -d) read     *
+ *                archives as well as text.                                *
+ * -Z III OOO     write the archive or binary maze in file III back out as *
+ *                text, placing it in file OOO.                            *
+ * -B III OOO     write the maze in file III in binary, with every cell at *
+ *                a fixed offset, placing it in file OOO. Solving ( -s)    *
+ *                and drawing ( -d) read binary mazes as well as text.     *
+ * -E III JJJ OOO find the cells that differ between the mazes in files    *
+ *                III and JJJ, placing the delta that turns III into JJJ   *
+ *                in binary file OOO.                                      *
+ * -P MMM DDD     apply the delta in file DDD to the maze in file MMM. A   *
+ *                binary maze is changed in place, one cell per change.    *
+ * -G III OOO     solve the square, torus, or hexagonal maze in file III,  *
+ *                placing the maze and the cells on its path in file OOO.  *
  * -c RRR CCC MMM create a maze with RRR rows and CCC columns, placing the *
  *                maze in file MMM.                                        *
+ * -g TTT         create the maze ( -c) on topology TTT, which is one of   *
+ *                square, torus, or hex, in the topology maze format.      *
+ * -l LLL         create the maze ( -c) with LLL levels joined by passages *
+ *                up and down, in the multi-level maze format.             *
+ * -k NNN         give each cell of the created maze ( -c) a random cost   *
+ *                from 1 to NNN for moving into it.                        *
+ * -b PPP         braid the created maze ( -c) by removing PPP percent of  *
+ *                its dead ends, which adds loops.                         *
+ * -o NNN         carve NNN open rooms into the created maze ( -c).        *
+ * -C DDD NNN     keep created mazes ( -c) and solutions ( -s) in the      *
+ *                cache directory DDD, using at most NNN megabytes, and    *
+ *                copy them from there instead of making them again.       *
  * -r NNN         seed a pseudo-random number generator with NNN; if the   *
  *                -r option is not given, use a random seed of 1.          *
+ * -I FFF III OOO draw the maze in file III as an image in format FFF,     *
+ *                which is pbm or pgm, placing it in file OOO.             *
+ * -H PPP         draw the path in file PPP, written by -R or -M, in gray  *
+ *                over the pgm image ( -I).                                *
+ * -X WWW III OOO draw the maze in file III as an SVG image, placing it in *
+ *                file OOO, with its path drawn over it if WWW is path or  *
+ *                without it if WWW is maze.                               *
+ * -W NNN         draw the image ( -I or -X) with cells NNN pixels wide;   *
+ *                if the -W option is not given, use 4.                    *
  *-d III          draw the created maze ( -c) or draw the solved maze      *
  *                ( -s) found in file III.                                 *
+ * -Y RRR CCC NNN MMM                                                      *
+ *                draw ( -d) only the NNN rows and MMM columns starting at *
+ *                row RRR and column CCC; a binary maze is read only where *
+ *                the window is. NNN or MMM of 0 reach the edge.           *
+ * -L SSS         draw ( -d) each SSS by SSS block of cells as one cell,   *
+ *                open to its neighbor where any passage crosses between.  *
+ * -a AAA         create the maze ( -c) with algorithm AAA, which is one   *
+ *                of dfs, backtrack, kruskal, wilson, hybrid, or bitboard; *
+ *                if the -a option is not given, use dfs.                  *
  *                                                                         *
  * Author: Alan Hencey                                                     *
  **************************************************************************/
@@ -22,6 +114,29 @@
 #include <string.h>
 #include "cell.h"
 #include "maze.h"
+#include "backtrack.h"
+#include "kruskal.h"
+#include "wilson.h"
+#include "stream.h"
+#include "lca.h"
+#include "dmaze.h"
+#include "flood.h"
+#include "dial.h"
+#include "braid.h"
+#include "astar.h"
+#include "nmaze.h"
+#include "tgrid.h"
+#include "valid.h"
+#include "stats.h"
+#include "pbfs.h"
+#include "bboard.h"
+#include "cache.h"
+#include "smaze.h"
+#include "arch.h"
+#include "delta.h"
+#include "route.h"
+#include "raster.h"
+#include "svg.h"
 
 // Necissary for random() and srandom() to work.
 long int random(void);
@@ -68,21 +183,144 @@ Fatal(char *fmt, ...)
 int
 ProcessOptions(int argc, char **argv)
     {
+    int QUERY = 0;
+    int queryMazeArg = 0;
+    int queryFileArg = 0;
+    int answerFileArg = 0;
+
+    int EDIT = 0;
+    int editMazeArg = 0;
+    int editFileArg = 0;
+    int editedFileArg = 0;
+
+    int FLOOD = 0;
+    int floodMazeArg = 0;
+    int floodPointsArg = 0;
+    int floodFileArg = 0;
+
     int CREATE = 0;
     int createRows = 0;
     int createCols = 0;
     int createFileArg = 0;
+    char *createAlgorithm = "dfs";
+    int createMaxCost = 1;
+    int createBraid = 0;
+    int createRooms = 0;
+    int createLevels = 0;
+    char *createTopology = 0;
+
+    int VALIDATE = 0;
+    int validateFileArg = 0;
+
+    int STATS = 0;
+    int statsFileArg = 0;
+    int statsJsonFileArg = 0;
+
+    int HARDEN = 0;
+    int hardenFileArg = 0;
+    int hardenedFileArg = 0;
 
     int SOLVE = 0;
     int solveFileArg = 0;
     int solutionFileArg = 0;
+    char *solveSearch = "bfs";
+    int solveThreads = 0;
+
+    int WEIGHTED = 0;
+    int weightedFileArg = 0;
+    int weightedSolutionFileArg = 0;
+
+    int LEVELS = 0;
+    int levelsFileArg = 0;
+    int levelsSolutionFileArg = 0;
+
+    int TOPOLOGY = 0;
+    int topologyFileArg = 0;
+    int topologySolutionFileArg = 0;
+
+    int PACK = 0;
+    int packFileArg = 0;
+    int packedFileArg = 0;
+
+    int PACKED = 0;
+    int packedSolveFileArg = 0;
+    int packedSolutionFileArg = 0;
+
+    int ARCHIVE = 0;
+    int archiveFileArg = 0;
+    int archivedFileArg = 0;
+
+    int UNARCHIVE = 0;
+    int unarchiveFileArg = 0;
+    int unarchivedFileArg = 0;
+
+    int BINARY = 0;
+    int binaryFileArg = 0;
+    int binaryOutFileArg = 0;
+
+    int DIFF = 0;
+    int diffFromArg = 0;
+    int diffToArg = 0;
+    int diffFileArg = 0;
+
+    int PATCH = 0;
+    int patchMazeArg = 0;
+    int patchFileArg = 0;
+
+    int DISTANCE = 0;
+    int distanceCodeArg = 0;
+    int distanceFileArg = 0;
+
+    int IMAGE = 0;
+    int imageFormatArg = 0;
+    int imageFileArg = 0;
+    int imageOutFileArg = 0;
+    int imagePixels = RASTER_PIXELS;
+    int imageRouteArg = 0;
+
+    int VECTOR = 0;
+    int vectorPathArg = 0;
+    int vectorFileArg = 0;
+    int vectorOutFileArg = 0;
+
+    int ROUTE = 0;
+    int routeFileArg = 0;
+    int routedFileArg = 0;
+
+    int MOVES = 0;
+    int movesFileArg = 0;
+    int movedFileArg = 0;
+
+    int OVERLAY = 0;
+    int overlayMazeArg = 0;
+    int overlayRouteArg = 0;
+
+    int CONVERT = 0;
+    int convertFileArg = 0;
+    int convertedFileArg = 0;
+
+    int STREAM = 0;
+    int streamFileArg = 0;
+    int streamSolutionFileArg = 0;
 
     int SEED = 0;
     int randomSeed = 1;
 
     int DRAW = 0;
+    int VIEW = 0;
+    int viewRow = 0;
+    int viewCol = 0;
+    int viewRows = 0;
+    int viewCols = 0;
+    int viewStep = 1;
     int drawFileArg = 0;
 
+    int cacheDirArg = 0;
+    long cacheMegabytes = 0;
+    CACHE *cache = 0;
+    unsigned long long createKey = 0;
+    unsigned long long solveKey = 0;
+
     int start,argIndex;
     int argsUsed;
     char *arg;
@@ -157,17 +395,224 @@ ProcessOptions(int argc, char **argv)
                 createFileArg = argIndex + 2;
                 argsUsed = 3;
                 break;
+            case 'a':
+                createAlgorithm = arg;
+                argsUsed = 1;
+                break;
+            case 'V':
+                VALIDATE = 1;
+                validateFileArg = argIndex;
+                argsUsed = 1;
+                break;
+            case 'i':
+                STATS = 1;
+                statsFileArg = argIndex;
+                statsJsonFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'D':
+                HARDEN = 1;
+                hardenFileArg = argIndex;
+                hardenedFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
             case 's':
                 SOLVE = 1;
                 solveFileArg = argIndex;
                 solutionFileArg = argIndex + 1;
                 argsUsed = 2;
                 break;
+            case 'x':
+                solveSearch = arg;
+                argsUsed = 1;
+                break;
+            case 'p':
+                solveThreads = atoi(arg);
+                argsUsed = 1;
+                break;
+            case 'b':
+                createBraid = atoi(arg);
+                argsUsed = 1;
+                break;
+            case 'o':
+                createRooms = atoi(arg);
+                argsUsed = 1;
+                break;
+            case 'l':
+                createLevels = atoi(arg);
+                argsUsed = 1;
+                break;
+            case 'g':
+                createTopology = arg;
+                argsUsed = 1;
+                break;
+            case 'G':
+                TOPOLOGY = 1;
+                topologyFileArg = argIndex;
+                topologySolutionFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'n':
+                LEVELS = 1;
+                levelsFileArg = argIndex;
+                levelsSolutionFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 't':
+                CONVERT = 1;
+                convertFileArg = argIndex;
+                convertedFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'k':
+                createMaxCost = atoi(arg);
+                argsUsed = 1;
+                break;
+            case 'w':
+                WEIGHTED = 1;
+                weightedFileArg = argIndex;
+                weightedSolutionFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'S':
+                STREAM = 1;
+                streamFileArg = argIndex;
+                streamSolutionFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'q':
+                QUERY = 1;
+                queryMazeArg = argIndex;
+                queryFileArg = argIndex + 1;
+                answerFileArg = argIndex + 2;
+                argsUsed = 3;
+                break;
+            case 'e':
+                EDIT = 1;
+                editMazeArg = argIndex;
+                editFileArg = argIndex + 1;
+                editedFileArg = argIndex + 2;
+                argsUsed = 3;
+                break;
+            case 'm':
+                FLOOD = 1;
+                floodMazeArg = argIndex;
+                floodPointsArg = argIndex + 1;
+                floodFileArg = argIndex + 2;
+                argsUsed = 3;
+                break;
+            case 'C':
+                cacheDirArg = argIndex;
+                cacheMegabytes = atol(argv[argIndex + 1]);
+                argsUsed = 2;
+                break;
+            case 'u':
+                PACK = 1;
+                packFileArg = argIndex;
+                packedFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'U':
+                PACKED = 1;
+                packedSolveFileArg = argIndex;
+                packedSolutionFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'z':
+                ARCHIVE = 1;
+                archiveFileArg = argIndex;
+                archivedFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'Z':
+                UNARCHIVE = 1;
+                unarchiveFileArg = argIndex;
+                unarchivedFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'B':
+                BINARY = 1;
+                binaryFileArg = argIndex;
+                binaryOutFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'E':
+                DIFF = 1;
+                diffFromArg = argIndex;
+                diffToArg = argIndex + 1;
+                diffFileArg = argIndex + 2;
+                argsUsed = 3;
+                break;
+            case 'P':
+                PATCH = 1;
+                patchMazeArg = argIndex;
+                patchFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'F':
+                DISTANCE = 1;
+                distanceCodeArg = argIndex;
+                distanceFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'I':
+                IMAGE = 1;
+                imageFormatArg = argIndex;
+                imageFileArg = argIndex + 1;
+                imageOutFileArg = argIndex + 2;
+                argsUsed = 3;
+                break;
+            case 'X':
+                VECTOR = 1;
+                vectorPathArg = argIndex;
+                vectorFileArg = argIndex + 1;
+                vectorOutFileArg = argIndex + 2;
+                argsUsed = 3;
+                break;
+            case 'W':
+                imagePixels = atoi(arg);
+                argsUsed = 1;
+                break;
+            case 'H':
+                imageRouteArg = argIndex;
+                argsUsed = 1;
+                break;
+            case 'R':
+                ROUTE = 1;
+                routeFileArg = argIndex;
+                routedFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'M':
+                MOVES = 1;
+                movesFileArg = argIndex;
+                movedFileArg = argIndex + 1;
+                argsUsed = 2;
+                break;
+            case 'O':
+                OVERLAY = 1;
+                overlayMazeArg = argIndex;
+                overlayRouteArg = argIndex + 1;
+                argsUsed = 2;
+                break;
             case 'd':
                 DRAW = 1;
                 drawFileArg = argIndex;
                 argsUsed = 1;
                 break;
+            case 'Y':
+                VIEW = 1;
+                viewRow = atoi(arg);
+                viewCol = atoi(argv[argIndex+1]);
+                viewRows = atoi(argv[argIndex+2]);
+                viewCols = atoi(argv[argIndex+3]);
+                argsUsed = 4;
+                break;
+            case 'L':
+                VIEW = 1;
+                viewStep = atoi(arg);
+                argsUsed = 1;
+                break;
             default:
                 printInvalidArgs();
                 exit(-1);
@@ -176,26 +621,442 @@ ProcessOptions(int argc, char **argv)
         argIndex += argsUsed;
         }
 
-        if (CREATE)
+        if (cacheDirArg)
+        {
+            cache = newCACHE(argv[cacheDirArg],cacheMegabytes * 1024 * 1024);
+            if (cache == 0) {Fatal("can't use cache directory %s.\n",
+                argv[cacheDirArg]);}
+        }
+
+        /* A cache hit has already written the file, so there is nothing
+           left to create. */
+        if (CREATE && cache)
         {
+            char text[256];
+            snprintf(text,sizeof(text),"create %s %d %d %d %d %d %d %d %s",
+                createAlgorithm,createRows,createCols,randomSeed,
+                createMaxCost,createBraid,createRooms,createLevels,
+                createTopology ? createTopology : "square");
+            createKey = keyCACHE(text,0);
+            CREATE = !fetchCACHE(cache,createKey,argv[createFileArg]);
+        }
+        if (CREATE && createLevels > 0)
+        {
+            if (createMaxCost != 1 || createBraid > 0 || createRooms > 0)
+                Fatal("costs, braiding, and rooms need a single level.\n");
+            int extents[3] = {createLevels,createRows,createCols};
+            FILE *createFile = fopen(argv[createFileArg],"w");
+            createNMAZE(3,extents,randomSeed,createFile);
+            fclose(createFile);
+        }
+        else if (CREATE && createTopology)
+        {
+            int kind = kindTGRID(createTopology);
+            if (kind < 0) {Fatal("unknown topology %s.\n",createTopology);}
+            if (createMaxCost != 1 || createBraid > 0 || createRooms > 0)
+                Fatal("costs, braiding, and rooms need a square maze.\n");
             FILE *createFile = fopen(argv[createFileArg],"w");
-            createMAZE(createRows,createCols,randomSeed,createFile);
+            createTGRID(kind,createRows,createCols,randomSeed,createFile);
             fclose(createFile);
         }
+        else if (CREATE)
+        {
+            FILE *createFile = fopen(argv[createFileArg],"w");
+            if (strcmp(createAlgorithm,"dfs") == 0)
+                createMAZE(createRows,createCols,randomSeed,createFile);
+            else if (strcmp(createAlgorithm,"backtrack") == 0)
+                createBACKTRACK(createRows,createCols,randomSeed,createFile);
+            else if (strcmp(createAlgorithm,"kruskal") == 0)
+                createKRUSKAL(createRows,createCols,randomSeed,createFile);
+            else if (strcmp(createAlgorithm,"wilson") == 0)
+                createWILSON(createRows,createCols,randomSeed,createFile);
+            else if (strcmp(createAlgorithm,"hybrid") == 0)
+                createHYBRID(createRows,createCols,randomSeed,createFile);
+            else if (strcmp(createAlgorithm,"bitboard") == 0)
+            {
+                if (createRows > BBOARD_MAX || createCols > BBOARD_MAX)
+                    Fatal("bitboard mazes must be at most %d x %d.\n",
+                        BBOARD_MAX,BBOARD_MAX);
+                createBBOARD(createRows,createCols,randomSeed,createFile);
+            }
+            else
+                Fatal("unknown algorithm %s.\n",createAlgorithm);
+            if (createMaxCost < 1 || createMaxCost > 255)
+                Fatal("costs must be from 1 to 255.\n");
+            if (createMaxCost > 1)
+                writeCOSTS(createRows,createCols,createMaxCost,randomSeed,
+                    createFile);
+            fclose(createFile);
+            if (createBraid < 0 || createBraid > 100)
+                Fatal("braiding must be from 0 to 100 percent.\n");
+            if (createBraid > 0 || createRooms > 0)
+            {
+                createFile = fopen(argv[createFileArg],"r");
+                GRID *g = readGRID(createFile);
+                fclose(createFile);
+                carveGRIDrooms(g,createRooms,randomSeed);
+                braidGRID(g,createBraid,randomSeed);
+                createFile = fopen(argv[createFileArg],"w");
+                writeGRID(g,createFile);
+                fclose(createFile);
+                freeGRID(g);
+            }
+        }
+        if (CREATE && cache) {storeCACHE(cache,createKey,argv[createFileArg]);}
+        if (HARDEN)
+        {
+            FILE *hardenFile = fopen(argv[hardenFileArg],"r");
+            if (hardenFile == 0) {Fatal("can't open %s.\n",
+                argv[hardenFileArg]);}
+            FILE *hardenedFile = fopen(argv[hardenedFileArg],"w");
+            long length = hardenMAZE(hardenFile,hardenedFile);
+            fclose(hardenFile);
+            fclose(hardenedFile);
+            if (length == -1) {Fatal("%s is not a maze.\n",
+                argv[hardenFileArg]);}
+        }
+        if (VALIDATE)
+        {
+            FILE *validateFile = fopen(argv[validateFileArg],"rb");
+            if (validateFile == 0) {Fatal("can't open %s.\n",
+                argv[validateFileArg]);}
+            printf("%s: ",argv[validateFileArg]);
+            int ok = validateMAZE(validateFile,stdout);
+            fclose(validateFile);
+            if (!ok) {Fatal("%s is not a valid maze.\n",
+                argv[validateFileArg]);}
+        }
+        if (STATS)
+        {
+            FILE *statsFile = fopen(argv[statsFileArg],"r");
+            if (statsFile == 0) {Fatal("can't open %s.\n",
+                argv[statsFileArg]);}
+            FILE *jsonFile = fopen(argv[statsJsonFileArg],"w");
+            int ok = statsMAZE(statsFile,jsonFile);
+            fclose(statsFile);
+            fclose(jsonFile);
+            if (!ok) {Fatal("%s is not a maze.\n",argv[statsFileArg]);}
+        }
+        if (ARCHIVE)
+        {
+            FILE *archiveFile = fopen(argv[archiveFileArg],"r");
+            if (archiveFile == 0) {Fatal("can't open %s.\n",
+                argv[archiveFileArg]);}
+            FILE *archivedFile = fopen(argv[archivedFileArg],"wb");
+            int ok = packARCHIVE(archiveFile,archivedFile);
+            fclose(archiveFile);
+            fclose(archivedFile);
+            if (!ok) {Fatal("%s is not a maze.\n",argv[archiveFileArg]);}
+        }
+        if (UNARCHIVE)
+        {
+            FILE *unarchiveFile = fopen(argv[unarchiveFileArg],"rb");
+            if (unarchiveFile == 0) {Fatal("can't open %s.\n",
+                argv[unarchiveFileArg]);}
+            FILE *unarchivedFile = fopen(argv[unarchivedFileArg],"w");
+            int ok = unpackARCHIVE(unarchiveFile,unarchivedFile);
+            fclose(unarchiveFile);
+            fclose(unarchivedFile);
+            if (!ok) {Fatal("%s is not a maze archive.\n",
+                argv[unarchiveFileArg]);}
+        }
+        if (BINARY)
+        {
+            FILE *binaryFile = fopen(argv[binaryFileArg],"rb");
+            if (binaryFile == 0) {Fatal("can't open %s.\n",
+                argv[binaryFileArg]);}
+            GRID *g = readGRID(binaryFile);
+            fclose(binaryFile);
+            if (g == 0) {Fatal("%s is not a maze.\n",argv[binaryFileArg]);}
+            FILE *binaryOutFile = fopen(argv[binaryOutFileArg],"wb");
+            writeGRIDbinary(g,binaryOutFile);
+            fclose(binaryOutFile);
+            freeGRID(g);
+        }
+        /* The maze to solve may have just been written by -Z or -B, so
+           the cache key is taken from the file only now. The distances
+           come out of the solve itself, so a cached solution can't be used
+           for them. */
+        if (SOLVE && cache && !DISTANCE)
+        {
+            char text[64];
+            snprintf(text,sizeof(text),"solve %s",solveSearch);
+            solveKey = keyCACHEfile(argv[solveFileArg],keyCACHE(text,0));
+            if (solveKey != 0)
+                SOLVE = !fetchCACHE(cache,solveKey,argv[solutionFileArg]);
+        }
+        if (DISTANCE && (!SOLVE || strcmp(solveSearch,"bfs") != 0))
+            Fatal("distances ( -F) need a solve ( -s) with bfs.\n");
         if (SOLVE)
         {
             FILE *solveFile = fopen(argv[solveFileArg],"r");
             FILE *solutionFile = fopen(argv[solutionFileArg],"w");
-            solveMAZE(solveFile,solutionFile);
+            if (strcmp(solveSearch,"bfs") == 0 && DISTANCE)
+            {
+                int varint = strcmp(argv[distanceCodeArg],"varint") == 0;
+                if (!varint && strcmp(argv[distanceCodeArg],"raw") != 0)
+                    Fatal("unknown distance encoding %s.\n",
+                        argv[distanceCodeArg]);
+                FILE *distanceFile = fopen(argv[distanceFileArg],"wb");
+                if (!solveMAZEdist(solveFile,solutionFile,distanceFile,varint))
+                    Fatal("%s is not a maze.\n",argv[solveFileArg]);
+                fclose(distanceFile);
+            }
+            else if (strcmp(solveSearch,"bfs") == 0)
+            {
+                if (!solveMAZE(solveFile,solutionFile))
+                    Fatal("%s is not a maze.\n",argv[solveFileArg]);
+            }
+            else if (strcmp(solveSearch,"astar") == 0)
+                solveASTAR(solveFile,solutionFile);
+            else if (strcmp(solveSearch,"jps") == 0)
+                solveJPS(solveFile,solutionFile);
+            else if (strcmp(solveSearch,"pbfs") == 0)
+                solvePBFS(solveFile,solutionFile,solveThreads);
+            else if (strcmp(solveSearch,"bitboard") == 0)
+            {
+                if (solveBBOARD(solveFile,solutionFile) == -2)
+                    Fatal("bitboard mazes must be at most %d x %d.\n",
+                        BBOARD_MAX,BBOARD_MAX);
+            }
+            else
+                Fatal("unknown search %s.\n",solveSearch);
             fclose(solveFile);
             fclose(solutionFile);
+            if (solveKey != 0)
+                storeCACHE(cache,solveKey,argv[solutionFileArg]);
+        }
+        if (ROUTE)
+        {
+            FILE *routeFile = fopen(argv[routeFileArg],"rb");
+            if (routeFile == 0) {Fatal("can't open %s.\n",
+                argv[routeFileArg]);}
+            FILE *routedFile = fopen(argv[routedFileArg],"wb");
+            long length = solveROUTE(routeFile,routedFile,0);
+            fclose(routeFile);
+            fclose(routedFile);
+            if (length == -1) {Fatal("%s has no solution.\n",
+                argv[routeFileArg]);}
+        }
+        if (MOVES)
+        {
+            FILE *movesFile = fopen(argv[movesFileArg],"rb");
+            if (movesFile == 0) {Fatal("can't open %s.\n",
+                argv[movesFileArg]);}
+            FILE *movedFile = fopen(argv[movedFileArg],"wb");
+            long length = solveROUTE(movesFile,movedFile,1);
+            fclose(movesFile);
+            fclose(movedFile);
+            if (length == -1) {Fatal("%s has no solution.\n",
+                argv[movesFileArg]);}
+        }
+        if (WEIGHTED)
+        {
+            FILE *weightedFile = fopen(argv[weightedFileArg],"r");
+            FILE *solutionFile = fopen(argv[weightedSolutionFileArg],"w");
+            solveWEIGHTED(weightedFile,solutionFile);
+            fclose(weightedFile);
+            fclose(solutionFile);
+        }
+        if (TOPOLOGY)
+        {
+            FILE *topologyFile = fopen(argv[topologyFileArg],"r");
+            FILE *solutionFile = fopen(argv[topologySolutionFileArg],"w");
+            long length = solveTGRID(topologyFile,solutionFile);
+            fclose(topologyFile);
+            fclose(solutionFile);
+            if (length == -1) {Fatal("%s has no solution.\n",
+                argv[topologyFileArg]);}
+        }
+        if (PACK)
+        {
+            FILE *packFile = fopen(argv[packFileArg],"r");
+            if (packFile == 0) {Fatal("can't open %s.\n",argv[packFileArg]);}
+            FILE *packedFile = fopen(argv[packedFileArg],"wb");
+            int ok = packSMAZE(packFile,packedFile);
+            fclose(packFile);
+            fclose(packedFile);
+            if (!ok) {Fatal("%s is not a perfect maze.\n",
+                argv[packFileArg]);}
+        }
+        if (PACKED)
+        {
+            FILE *packedFile = fopen(argv[packedSolveFileArg],"rb");
+            if (packedFile == 0) {Fatal("can't open %s.\n",
+                argv[packedSolveFileArg]);}
+            FILE *solutionFile = fopen(argv[packedSolutionFileArg],"w");
+            long length = solveSMAZE(packedFile,solutionFile);
+            fclose(packedFile);
+            fclose(solutionFile);
+            if (length == -1) {Fatal("%s is not a packed maze.\n",
+                argv[packedSolveFileArg]);}
+        }
+        if (CONVERT)
+        {
+            FILE *convertFile = fopen(argv[convertFileArg],"rb");
+            FILE *convertedFile = fopen(argv[convertedFileArg],"wb");
+            int ok = convertNMAZE(convertFile,convertedFile);
+            fclose(convertFile);
+            fclose(convertedFile);
+            if (!ok) {Fatal("%s is not a multi-level maze.\n",
+                argv[convertFileArg]);}
+        }
+        if (LEVELS)
+        {
+            FILE *levelsFile = fopen(argv[levelsFileArg],"rb");
+            FILE *solutionFile = fopen(argv[levelsSolutionFileArg],"w");
+            long length = solveNMAZE(levelsFile,solutionFile);
+            fclose(levelsFile);
+            fclose(solutionFile);
+            if (length == -1) {Fatal("%s has no solution.\n",
+                argv[levelsFileArg]);}
+        }
+        if (STREAM)
+        {
+            FILE *streamFile = fopen(argv[streamFileArg],"r");
+            FILE *solutionFile = fopen(argv[streamSolutionFileArg],"w");
+            long length = streamSOLVE(streamFile,solutionFile);
+            fclose(streamFile);
+            fclose(solutionFile);
+            if (length == -2) {Fatal("%s is not a perfect maze.\n",
+                argv[streamFileArg]);}
+            if (length == -1) {Fatal("%s has no solution.\n",
+                argv[streamFileArg]);}
+        }
+        if (QUERY)
+        {
+            FILE *mazeFile = fopen(argv[queryMazeArg],"r");
+            FILE *queryFile = fopen(argv[queryFileArg],"r");
+            FILE *answerFile = fopen(argv[answerFileArg],"w");
+            int ok = queryMAZE(mazeFile,queryFile,answerFile);
+            fclose(mazeFile);
+            fclose(queryFile);
+            fclose(answerFile);
+            if (!ok) {Fatal("%s is not a perfect maze.\n",argv[queryMazeArg]);}
+        }
+        if (EDIT)
+        {
+            FILE *mazeFile = fopen(argv[editMazeArg],"r");
+            FILE *editFile = fopen(argv[editFileArg],"r");
+            FILE *editedFile = fopen(argv[editedFileArg],"w");
+            editMAZE(mazeFile,editFile,editedFile);
+            fclose(mazeFile);
+            fclose(editFile);
+            fclose(editedFile);
+        }
+        if (FLOOD)
+        {
+            FILE *mazeFile = fopen(argv[floodMazeArg],"r");
+            FILE *pointsFile = fopen(argv[floodPointsArg],"r");
+            FILE *floodFile = fopen(argv[floodFileArg],"wb");
+            int ok = floodMAZE(mazeFile,pointsFile,floodFile);
+            fclose(mazeFile);
+            fclose(pointsFile);
+            fclose(floodFile);
+            if (!ok) {Fatal("%s has no sources.\n",argv[floodPointsArg]);}
+        }
+        if (DIFF)
+        {
+            FILE *fromFile = fopen(argv[diffFromArg],"rb");
+            FILE *toFile = fopen(argv[diffToArg],"rb");
+            if (fromFile == 0 || toFile == 0) {Fatal("can't open %s.\n",
+                fromFile ? argv[diffToArg] : argv[diffFromArg]);}
+            FILE *diffFile = fopen(argv[diffFileArg],"wb");
+            long changed = diffMAZE(fromFile,toFile,diffFile);
+            fclose(fromFile);
+            fclose(toFile);
+            fclose(diffFile);
+            if (changed == -1) {Fatal("%s and %s are not mazes of the same "
+                "size.\n",argv[diffFromArg],argv[diffToArg]);}
+        }
+        if (PATCH)
+        {
+            FILE *patchFile = fopen(argv[patchFileArg],"rb");
+            if (patchFile == 0) {Fatal("can't open %s.\n",
+                argv[patchFileArg]);}
+            long changed = patchMAZE(argv[patchMazeArg],patchFile);
+            fclose(patchFile);
+            if (changed == -2) {Fatal("%s is not a maze delta.\n",
+                argv[patchFileArg]);}
+            if (changed == -1) {Fatal("%s does not match %s.\n",
+                argv[patchFileArg],argv[patchMazeArg]);}
+            if (changed == -3) {Fatal("%s changes values or costs, which "
+                "archive %s can't keep.\n",argv[patchFileArg],
+                argv[patchMazeArg]);}
+        }
+        if (IMAGE)
+        {
+            int gray = strcmp(argv[imageFormatArg],"pgm") == 0;
+            if (!gray && strcmp(argv[imageFormatArg],"pbm") != 0)
+                Fatal("unknown image format %s.\n",argv[imageFormatArg]);
+            if (imagePixels < 2) {Fatal("cells must be at least 2 pixels.\n");}
+            FILE *imageFile = fopen(argv[imageFileArg],"rb");
+            if (imageFile == 0) {Fatal("can't open %s.\n",
+                argv[imageFileArg]);}
+            FILE *imageRouteFile = 0;
+            if (imageRouteArg)
+            {
+                if (!gray) {Fatal("a path ( -H) needs a pgm image.\n");}
+                imageRouteFile = fopen(argv[imageRouteArg],"rb");
+                if (imageRouteFile == 0) {Fatal("can't open %s.\n",
+                    argv[imageRouteArg]);}
+            }
+            FILE *imageOutFile = fopen(argv[imageOutFileArg],"wb");
+            int ok = rasterMAZE(imageFile,imageRouteFile,imageOutFile,
+                imagePixels,gray);
+            fclose(imageFile);
+            if (imageRouteFile) {fclose(imageRouteFile);}
+            fclose(imageOutFile);
+            if (ok == 0) {Fatal("%s is not a maze.\n",argv[imageFileArg]);}
+            if (ok == -1) {Fatal("%s is not a path through %s.\n",
+                argv[imageRouteArg],argv[imageFileArg]);}
+        }
+        if (VECTOR)
+        {
+            int path = strcmp(argv[vectorPathArg],"path") == 0;
+            if (!path && strcmp(argv[vectorPathArg],"maze") != 0)
+                Fatal("unknown drawing %s.\n",argv[vectorPathArg]);
+            if (imagePixels < 2) {Fatal("cells must be at least 2 pixels.\n");}
+            FILE *vectorFile = fopen(argv[vectorFileArg],"rb");
+            if (vectorFile == 0) {Fatal("can't open %s.\n",
+                argv[vectorFileArg]);}
+            FILE *vectorOutFile = fopen(argv[vectorOutFileArg],"w");
+            long segments = svgMAZE(vectorFile,vectorOutFile,imagePixels,path);
+            fclose(vectorFile);
+            fclose(vectorOutFile);
+            if (segments == -1) {Fatal("%s is not a maze.\n",
+                argv[vectorFileArg]);}
+        }
+        if (OVERLAY)
+        {
+            FILE *mazeFile = fopen(argv[overlayMazeArg],"rb");
+            FILE *routeFile = fopen(argv[overlayRouteArg],"rb");
+            if (mazeFile == 0 || routeFile == 0) {Fatal("can't open %s.\n",
+                mazeFile ? argv[overlayRouteArg] : argv[overlayMazeArg]);}
+            long length = drawROUTE(mazeFile,routeFile);
+            fclose(mazeFile);
+            fclose(routeFile);
+            if (length == -1) {Fatal("%s is not a path through %s.\n",
+                argv[overlayRouteArg],argv[overlayMazeArg]);}
         }
         if (DRAW)
         {
             FILE *drawFile = fopen(argv[drawFileArg],"r");
-            drawMAZE(drawFile);
+            if (VIEW)
+            {
+                if (viewStep < 1) {Fatal("blocks must be at least 1 cell.\n");}
+                if (drawFile == 0) {Fatal("can't open %s.\n",
+                    argv[drawFileArg]);}
+                if (!drawMAZEview(drawFile,viewRow,viewCol,viewRows,
+                    viewCols,viewStep))
+                    Fatal("%s is not a maze or doesn't hold row %d, "
+                        "column %d.\n",argv[drawFileArg],viewRow,viewCol);
+            }
+            else if (!drawMAZE(drawFile))
+                Fatal("%s is not a maze.\n",argv[drawFileArg]);
             fclose(drawFile);
         }
+        if (cache) {freeCACHE(cache);}
 
     return argIndex;
     }
@@ -207,15 +1068,143 @@ void printInvalidArgs()
     printf("option             action\n");
     printf("-v                 gives author's name; the program exits\n");
     printf("                   immediately after the name is printed.\n\n");
+    printf("-V III             checks that the maze in file III is well\n");
+    printf("                   formed and is a perfect maze, with its\n");
+    printf("                   entrance and exit open.\n\n");
+    printf("-i III OOO         measures the maze in file III, placing its\n");
+    printf("                   dead ends, junctions, corridors, solution,\n");
+    printf("                   and diameter in file OOO as JSON.\n\n");
+    printf("-D III OOO         moves the entrance and exit of the maze in\n");
+    printf("                   file III to the ends of its longest path,\n");
+    printf("                   placing it in file OOO.\n\n");
     printf("-s III OOO         solves the maze in file III placing\n");
     printf("                   the solution in file OOO.\n\n");
+    printf("-x SSS             solves the maze ( -s) with search SSS,\n");
+    printf("                   which is one of bfs, astar, jps, pbfs, or\n");
+    printf("                   bitboard; all but bfs place only the path\n");
+    printf("                   in the solution. If the -x option is not\n");
+    printf("                   given, bfs is used.\n\n");
+    printf("-p NNN             runs the pbfs search ( -x) on NNN threads;\n");
+    printf("                   if the -p option is not given, one thread\n");
+    printf("                   is used for each core.\n\n");
+    printf("-F EEE OOO         also places the exact distance of every\n");
+    printf("                   cell from the entrance, found by the solve\n");
+    printf("                   ( -s) with bfs, in binary file OOO,\n");
+    printf("                   written as EEE, which is raw or varint.\n\n");
+    printf("-w III OOO         solves the weighted maze in file III by\n");
+    printf("                   cheapest path, placing only the path in\n");
+    printf("                   file OOO.\n\n");
+    printf("-S III OOO         solves the perfect maze in file III one row\n");
+    printf("                   at a time, placing only the path in file\n");
+    printf("                   OOO.\n\n");
+    printf("-R III OOO         solves the maze in file III, placing only\n");
+    printf("                   its path in file OOO as runs of moves,\n");
+    printf("                   such as R12 D3 L4.\n\n");
+    printf("-M III OOO         solves the maze in file III, placing only\n");
+    printf("                   its path in binary file OOO, two bits to\n");
+    printf("                   a move.\n\n");
+    printf("-O MMM PPP         draws the maze in file MMM with the path in\n");
+    printf("                   file PPP, written by -R or -M, laid over\n");
+    printf("                   it.\n\n");
+    printf("-q III QQQ OOO     answers the queries in file QQQ against the\n");
+    printf("                   perfect maze in file III, placing the\n");
+    printf("                   answers in file OOO. Each query is a line\n");
+    printf("                   \"R1 C1 R2 C2\"; each answer is the distance\n");
+    printf("                   followed by the row and column of every\n");
+    printf("                   cell on the path.\n\n");
+    printf("-e III EEE OOO     applies the wall edits in file EEE to the\n");
+    printf("                   maze in file III, placing the edited maze\n");
+    printf("                   and its path in file OOO. Each edit is a\n");
+    printf("                   line \"+ R C W\" to add wall W of the cell at\n");
+    printf("                   row R and column C, or \"- R C W\" to\n");
+    printf("                   remove it.\n\n");
+    printf("-m III PPP OOO     finds the nearest source and its distance\n");
+    printf("                   for every cell of the maze in file III,\n");
+    printf("                   placing them in binary file OOO. File PPP\n");
+    printf("                   holds lines \"S R C\" for each source and\n");
+    printf("                   \"G R C\" for each goal; the search stops\n");
+    printf("                   once every goal is reached.\n\n");
+    printf("-n III OOO         solves the multi-level maze in file III,\n");
+    printf("                   placing the maze and the cells on its\n");
+    printf("                   path in file OOO.\n\n");
+    printf("-t III OOO         converts the multi-level maze in file III\n");
+    printf("                   from text to binary or from binary to\n");
+    printf("                   text, placing it in file OOO.\n\n");
+    printf("-u III OOO         packs the perfect maze in file III into two\n");
+    printf("                   bits per cell, placing it in binary file\n");
+    printf("                   OOO.\n\n");
+    printf("-U III OOO         solves the packed maze in file III without\n");
+    printf("                   unpacking it, placing the maze and its\n");
+    printf("                   path in file OOO.\n\n");
+    printf("-z III OOO         compresses the maze in file III into an\n");
+    printf("                   archive, placing it in file OOO. Solving\n");
+    printf("                   ( -s) and drawing ( -d) read archives as\n");
+    printf("                   well as text.\n\n");
+    printf("-Z III OOO         writes the archive or binary maze in file\n");
+    printf("                   III back out as text, placing it in file\n");
+    printf("                   OOO.\n\n");
+    printf("-B III OOO         writes the maze in file III in binary,\n");
+    printf("                   with every cell at a fixed offset, placing\n");
+    printf("                   it in file OOO. Solving ( -s) and drawing\n");
+    printf("                   ( -d) read binary mazes as well as text.\n\n");
+    printf("-E III JJJ OOO     finds the cells that differ between the\n");
+    printf("                   mazes in files III and JJJ, placing the\n");
+    printf("                   delta that turns III into JJJ in binary\n");
+    printf("                   file OOO.\n\n");
+    printf("-P MMM DDD         applies the delta in file DDD to the maze\n");
+    printf("                   in file MMM. A binary maze is changed in\n");
+    printf("                   place, one cell per change.\n\n");
+    printf("-G III OOO         solves the square, torus, or hexagonal maze\n");
+    printf("                   in file III, placing the maze and the\n");
+    printf("                   cells on its path in file OOO.\n\n");
     printf("-c RRR CCC MMM     creates a maze with RRR rows and CCC\n");
     printf("                   columns, placing the maze in file MMM.\n\n");
+    printf("-g TTT             creates the maze ( -c) on topology TTT,\n");
+    printf("                   which is one of square, torus, or hex, in\n");
+    printf("                   the topology maze format.\n\n");
+    printf("-l LLL             creates the maze ( -c) with LLL levels\n");
+    printf("                   joined by passages up and down, in the\n");
+    printf("                   multi-level maze format.\n\n");
+    printf("-k NNN             gives each cell of the created maze ( -c) a\n");
+    printf("                   random cost from 1 to NNN for moving into\n");
+    printf("                   it.\n\n");
+    printf("-b PPP             braids the created maze ( -c) by removing\n");
+    printf("                   PPP percent of its dead ends, which adds\n");
+    printf("                   loops.\n\n");
+    printf("-o NNN             carves NNN open rooms into the created\n");
+    printf("                   maze ( -c).\n\n");
+    printf("-C DDD NNN         keeps created mazes ( -c) and solutions\n");
+    printf("                   ( -s) in the cache directory DDD, using at\n");
+    printf("                   most NNN megabytes, and copies them from\n");
+    printf("                   there instead of making them again.\n\n");
     printf("-r NNN             seeds a pseudo-random number generator\n");
     printf("                   with NNN; if the -r option is not given,\n");
     printf("                   a random seed of 1 is used.\n\n");
+    printf("-I FFF III OOO     draws the maze in file III as an image in\n");
+    printf("                   format FFF, which is pbm or pgm, placing\n");
+    printf("                   it in file OOO.\n\n");
+    printf("-H PPP             draws the path in file PPP, written by -R\n");
+    printf("                   or -M, in gray over the pgm image ( -I).\n\n");
+    printf("-X WWW III OOO     draws the maze in file III as an SVG image,\n");
+    printf("                   placing it in file OOO, with its path drawn\n");
+    printf("                   over it if WWW is path or without it if WWW\n");
+    printf("                   is maze.\n\n");
+    printf("-W NNN             draws the image ( -I or -X) with cells NNN\n");
+    printf("                   pixels wide; if the -W option is not given,\n");
+    printf("                   4 is used.\n\n");
     printf("-d III             draws the created maze ( -c) or draws the\n");
     printf("                   solved maze ( -s) found in file III.\n\n");
+    printf("-Y RRR CCC NNN MMM draws ( -d) only the NNN rows and MMM\n");
+    printf("                   columns starting at row RRR and column\n");
+    printf("                   CCC; a binary maze is read only where the\n");
+    printf("                   window is. NNN or MMM of 0 reach the edge.\n\n");
+    printf("-L SSS             draws ( -d) each SSS by SSS block of cells\n");
+    printf("                   as one cell, open to its neighbor where any\n");
+    printf("                   passage crosses between them.\n\n");
+    printf("-a AAA             creates the maze ( -c) with algorithm AAA,\n");
+    printf("                   which is one of dfs, backtrack, kruskal,\n");
+    printf("                   wilson, hybrid, or bitboard; if the -a\n");
+    printf("                   option is not given, dfs is used.\n\n");
 }
 
 void printAuthor() {printf("Written by Alan Hencey\n");}
@@ -0,0 +1,441 @@
+/***************************************************************************
+ * This module stores mazes compressed with a range coder, in blocks of    *
+ * rows that can be read one after another from a pipe or picked out by    *
+ * number. Only the walls and the entrance and exit are kept; the walls    *
+ * are the same bits the text format writes, one for each wall to the      *
+ * left of a cell, one for the right edge, and one for each bottom wall    *
+ * above the last row.                                                     *
+ *                                                                         *
+ * Each bit is coded with an adaptive probability chosen by the walls next *
+ * to it that have already been coded. In a perfect maze these say a lot:  *
+ * a cell closed on three sides must be open on the fourth, and walls tend *
+ * to continue in straight lines. The probabilities start over with each   *
+ * block, and each block also codes the bottom walls of the row just above *
+ * it, so a block can be decoded on its own.                               *
+ *                                                                         *
+ * The file format is:                                                     *
+ *                                                                         *
+ *   "MZAR" version rows cols blockRows blocks 0  (unsigned 32-bit)        *
+ *   start goal                                  (unsigned 64-bit)         *
+ *   for each block: its length (unsigned 32-bit) and its coded bytes      *
+ *   offset of each block from the start of the file (unsigned 64-bit)     *
+ *   offset of that index (unsigned 64-bit) and "MZAX"                     *
+ *                                                                         *
+ * Integers are in the byte order of the machine that wrote them. The      *
+ * index is at the end so the file can be written in one pass, and it is   *
+ * only needed to jump to a block.                                         *
+ *                                                                         *
+ * The range coder is the one used by LZMA: 11 bit probabilities that move *
+ * a thirty-second of the way towards each bit coded.                      *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "arch.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define ARCHIVE_VERSION 1
+#define PROB_BITS 11
+#define MOVE_BITS 5
+#define TOP_VALUE ((uint32_t)1 << 24)
+#define VERT_CONTEXTS 20
+#define BOTTOM_CONTEXTS 16
+
+struct archive
+{
+    FILE *fp;
+    int rows;
+    int cols;
+    int blockRows;
+    int blocks;
+    long start;
+    long goal;
+    int next;
+    unsigned char *bytes;
+    long capacity;
+    unsigned char *vert;
+    unsigned char *bottom;
+    unsigned char *top;
+};
+
+/* One coder both encodes and decodes, so that the walk over the bits in
+   codeBlock is written only once and the two can't disagree. */
+typedef struct coder
+{
+    int encoding;
+    uint64_t low;
+    uint32_t range;
+    uint32_t code;
+    unsigned char cache;
+    long cacheSize;
+    unsigned char *bytes;
+    long size;
+    long capacity;
+    long pos;
+    uint16_t vertProb[VERT_CONTEXTS];
+    uint16_t bottomProb[BOTTOM_CONTEXTS];
+    uint16_t topProb[2];
+} CODER;
+
+static void startCoder(CODER *k,int encoding,unsigned char *bytes,long size);
+static int  codeBit(CODER *k,uint16_t *prob,int bit);
+static void shiftLow(CODER *k);
+static void putByte(CODER *k,unsigned char b);
+static void finishCoder(CODER *k);
+static void codeBlock(CODER *k,unsigned char *top,unsigned char *vert,
+                      unsigned char *bottom,int firstRow,int count,
+                      int rows,int cols);
+
+/* Reads the header. Returns 0 if the file isn't an archive. */
+ARCHIVE *openARCHIVE(FILE *fp)
+{
+    char magic[4];
+    if (fread(magic,1,4,fp) != 4 || memcmp(magic,"MZAR",4) != 0) {return 0;}
+    return openARCHIVEheader(fp);
+}
+
+/* Reads the header of an archive whose "MZAR" has already been read. */
+ARCHIVE *openARCHIVEheader(FILE *fp)
+{
+    uint32_t header[6];
+    uint64_t ends[2];
+    if (fread(header,sizeof(uint32_t),6,fp) != 6) {return 0;}
+    if (fread(ends,sizeof(uint64_t),2,fp) != 2) {return 0;}
+    if (header[0] != ARCHIVE_VERSION || header[1] == 0 || header[2] == 0 ||
+        header[3] == 0) {return 0;}
+
+    ARCHIVE *a = malloc(sizeof(ARCHIVE));
+    assert(a != 0);
+    a->fp = fp;
+    a->rows = header[1];
+    a->cols = header[2];
+    a->blockRows = header[3];
+    a->blocks = header[4];
+    a->start = ends[0];
+    a->goal = ends[1];
+    a->next = 0;
+    a->capacity = 1024;
+    a->bytes = malloc(a->capacity);
+    a->vert = malloc((long)a->blockRows * (a->cols + 1));
+    a->bottom = malloc((long)a->blockRows * a->cols);
+    a->top = malloc(a->cols);
+    assert(a->bytes != 0 && a->vert != 0 && a->bottom != 0 && a->top != 0);
+    return a;
+}
+
+int getARCHIVErows(ARCHIVE *a) {return a->rows;}
+
+int getARCHIVEcols(ARCHIVE *a) {return a->cols;}
+
+int getARCHIVEblockRows(ARCHIVE *a) {return a->blockRows;}
+
+int getARCHIVEblocks(ARCHIVE *a) {return a->blocks;}
+
+long getARCHIVEstart(ARCHIVE *a) {return a->start;}
+
+long getARCHIVEgoal(ARCHIVE *a) {return a->goal;}
+
+/* Decodes the next block into walls, one byte per cell in the bits used
+   by getGRIDwalls, and returns its number of rows. Returns 0 after the
+   last block and -1 if the file is cut short. */
+int nextARCHIVEblock(ARCHIVE *a,unsigned char *walls)
+{
+    if (a->next >= a->blocks) {return 0;}
+    uint32_t length;
+    if (fread(&length,sizeof(uint32_t),1,a->fp) != 1) {return -1;}
+    if (length > a->capacity)
+    {
+        a->capacity = length;
+        a->bytes = realloc(a->bytes,a->capacity);
+        assert(a->bytes != 0);
+    }
+    if (fread(a->bytes,1,length,a->fp) != length) {return -1;}
+
+    int cols = a->cols;
+    int firstRow = a->next * a->blockRows;
+    int count = a->rows - firstRow;
+    if (count > a->blockRows) {count = a->blockRows;}
+    ++a->next;
+
+    CODER k;
+    startCoder(&k,0,a->bytes,length);
+    codeBlock(&k,a->top,a->vert,a->bottom,firstRow,count,a->rows,cols);
+
+    for (int r = 0; r < count; ++r)
+    {
+        unsigned char *v = a->vert + (long)r * (cols + 1);
+        unsigned char *b = a->bottom + (long)r * cols;
+        unsigned char *above = r > 0 ? b - cols : a->top;
+        for (int c = 0; c < cols; ++c)
+            walls[(long)r * cols + c] = above[c] | v[c] << 1 | v[c+1] << 2
+                | b[c] << 3;
+    }
+    return count;
+}
+
+/* Moves to a block using the index. Returns 0 if the file can't seek or
+   has no index. */
+int seekARCHIVEblock(ARCHIVE *a,int block)
+{
+    if (block < 0 || block >= a->blocks) {return 0;}
+    char magic[4];
+    uint64_t indexOffset, offset;
+    if (fseek(a->fp,-12,SEEK_END) != 0) {return 0;}
+    if (fread(&indexOffset,sizeof(uint64_t),1,a->fp) != 1 ||
+        fread(magic,1,4,a->fp) != 4 || memcmp(magic,"MZAX",4) != 0)
+        return 0;
+    if (fseek(a->fp,indexOffset + (long)block * sizeof(uint64_t),SEEK_SET)
+        != 0 || fread(&offset,sizeof(uint64_t),1,a->fp) != 1)
+        return 0;
+    if (fseek(a->fp,offset,SEEK_SET) != 0) {return 0;}
+    a->next = block;
+    return 1;
+}
+
+/* Frees the archive but leaves its file open. */
+void closeARCHIVE(ARCHIVE *a)
+{
+    free(a->bytes);
+    free(a->vert);
+    free(a->bottom);
+    free(a->top);
+    free(a);
+}
+
+/* Writes the walls and ends of the grid and returns the bytes written.
+   Values and costs are not kept. */
+long writeARCHIVE(GRID *g,int blockRows,FILE *fp)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    if (blockRows < 1) {blockRows = ARCHIVE_BLOCK_ROWS;}
+    int blocks = (rows + blockRows - 1) / blockRows;
+
+    uint32_t header[6] = {ARCHIVE_VERSION,rows,cols,blockRows,blocks,0};
+    uint64_t ends[2] = {getGRIDstart(g),getGRIDgoal(g)};
+    fwrite("MZAR",1,4,fp);
+    fwrite(header,sizeof(uint32_t),6,fp);
+    fwrite(ends,sizeof(uint64_t),2,fp);
+    uint64_t offset = 4 + sizeof(header) + sizeof(ends);
+
+    uint64_t *index = malloc(sizeof(uint64_t) * blocks);
+    unsigned char *vert = malloc((long)blockRows * (cols + 1));
+    unsigned char *bottom = malloc((long)blockRows * cols);
+    unsigned char *top = malloc(cols);
+    assert(index != 0 && vert != 0 && bottom != 0 && top != 0);
+
+    for (int block = 0; block < blocks; ++block)
+    {
+        int firstRow = block * blockRows;
+        int count = rows - firstRow < blockRows ? rows - firstRow : blockRows;
+        for (int c = 0; c < cols; ++c)
+            top[c] = firstRow > 0 ? getGRIDwall(g,firstRow - 1,c,3) : 1;
+        for (int r = 0; r < count; ++r)
+        {
+            int row = firstRow + r;
+            unsigned char *v = vert + (long)r * (cols + 1);
+            for (int c = 0; c < cols; ++c)
+            {
+                v[c] = getGRIDwall(g,row,c,1);
+                bottom[(long)r * cols + c] = getGRIDwall(g,row,c,3);
+            }
+            v[cols] = getGRIDwall(g,row,cols - 1,2);
+        }
+
+        CODER k;
+        startCoder(&k,1,0,0);
+        codeBlock(&k,top,vert,bottom,firstRow,count,rows,cols);
+        finishCoder(&k);
+
+        uint32_t length = k.size;
+        index[block] = offset;
+        fwrite(&length,sizeof(uint32_t),1,fp);
+        fwrite(k.bytes,1,length,fp);
+        offset += sizeof(uint32_t) + length;
+        free(k.bytes);
+    }
+
+    fwrite(index,sizeof(uint64_t),blocks,fp);
+    fwrite(&offset,sizeof(uint64_t),1,fp);
+    fwrite("MZAX",1,4,fp);
+
+    free(index);
+    free(vert);
+    free(bottom);
+    free(top);
+    return offset + sizeof(uint64_t) * (blocks + 1) + 4;
+}
+
+/* Returns 0 if the file doesn't hold a maze. */
+int packARCHIVE(FILE *readFile,FILE *writeFile)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return 0;}
+    writeARCHIVE(g,ARCHIVE_BLOCK_ROWS,writeFile);
+    freeGRID(g);
+    return 1;
+}
+
+/* Writes an archive back out in the text format. readGRID reads archives
+   as well as text, so this is just a read and a write. */
+int unpackARCHIVE(FILE *readFile,FILE *writeFile)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return 0;}
+    writeGRID(g,writeFile);
+    freeGRID(g);
+    return 1;
+}
+
+/* Codes the bits of count rows starting at firstRow. Before them come the
+   bottom walls of the row above, in top, unless firstRow is 0. The bottom
+   walls of the last row of the maze are outer walls and aren't coded. */
+static void codeBlock(CODER *k,unsigned char *top,unsigned char *vert,
+                      unsigned char *bottom,int firstRow,int count,
+                      int rows,int cols)
+{
+    int prev = 1;
+    for (int c = 0; c < cols; ++c)
+    {
+        if (firstRow == 0) {top[c] = 1;}
+        else {top[c] = prev = codeBit(k,&k->topProb[prev],top[c]);}
+    }
+
+    for (int r = 0; r < count; ++r)
+    {
+        unsigned char *v = vert + (long)r * (cols + 1);
+        unsigned char *b = bottom + (long)r * cols;
+        unsigned char *aboveV = r > 0 ? v - (cols + 1) : 0;
+        unsigned char *aboveB = r > 0 ? b - cols : top;
+
+        /* A wall to the left of a cell is predicted by the one above it,
+           the one before it, and the two bottom walls meeting its top. */
+        for (int c = 0; c <= cols; ++c)
+        {
+            int above = aboveV ? aboveV[c] : 1;
+            int ctx;
+            if (c == 0 || c == cols) {ctx = 16 + (c == cols) * 2 + above;}
+            else
+                ctx = above | v[c-1] << 1 | aboveB[c-1] << 2
+                    | aboveB[c] << 3;
+            v[c] = codeBit(k,&k->vertProb[ctx],v[c]);
+        }
+
+        /* A bottom wall is predicted by the other three walls of its cell
+           and the bottom wall before it. */
+        if (firstRow + r == rows - 1)
+        {
+            for (int c = 0; c < cols; ++c) {b[c] = 1;}
+            continue;
+        }
+        for (int c = 0; c < cols; ++c)
+        {
+            int ctx = v[c] | v[c+1] << 1 | (c > 0 ? b[c-1] : 1) << 2
+                | aboveB[c] << 3;
+            b[c] = codeBit(k,&k->bottomProb[ctx],b[c]);
+        }
+    }
+}
+
+static void startCoder(CODER *k,int encoding,unsigned char *bytes,long size)
+{
+    k->encoding = encoding;
+    k->low = 0;
+    k->range = 0xFFFFFFFFu;
+    k->code = 0;
+    k->cache = 0;
+    k->cacheSize = 1;
+    k->bytes = bytes;
+    k->size = size;
+    k->capacity = 0;
+    k->pos = 0;
+    for (int i = 0; i < VERT_CONTEXTS; ++i)
+        k->vertProb[i] = 1 << (PROB_BITS - 1);
+    for (int i = 0; i < BOTTOM_CONTEXTS; ++i)
+        k->bottomProb[i] = 1 << (PROB_BITS - 1);
+    k->topProb[0] = k->topProb[1] = 1 << (PROB_BITS - 1);
+
+    if (encoding)
+    {
+        k->capacity = 256;
+        k->bytes = malloc(k->capacity);
+        assert(k->bytes != 0);
+        k->size = 0;
+    }
+    else
+    {
+        // Bytes past the end of a cut short block read as 0.
+        for (int i = 0; i < 5; ++i)
+            k->code = k->code << 8 | (k->pos < size ? bytes[k->pos++] : 0);
+    }
+}
+
+/* Encodes bit, or decodes one and ignores bit, and returns it. */
+static int codeBit(CODER *k,uint16_t *prob,int bit)
+{
+    uint32_t bound = (k->range >> PROB_BITS) * *prob;
+    if (!k->encoding) {bit = k->code >= bound;}
+
+    if (!bit)
+    {
+        k->range = bound;
+        *prob += ((1 << PROB_BITS) - *prob) >> MOVE_BITS;
+    }
+    else
+    {
+        if (k->encoding) {k->low += bound;}
+        else {k->code -= bound;}
+        k->range -= bound;
+        *prob -= *prob >> MOVE_BITS;
+    }
+
+    while (k->range < TOP_VALUE)
+    {
+        k->range <<= 8;
+        if (k->encoding) {shiftLow(k);}
+        else
+            k->code = k->code << 8
+                | (k->pos < k->size ? k->bytes[k->pos++] : 0);
+    }
+    return bit;
+}
+
+/* Holds back bytes of 0xFF until it is known whether a carry will reach
+   them. */
+static void shiftLow(CODER *k)
+{
+    if ((uint32_t)k->low < 0xFF000000u || (k->low >> 32) != 0)
+    {
+        unsigned char carry = k->low >> 32;
+        unsigned char temp = k->cache;
+        do
+        {
+            putByte(k,temp + carry);
+            temp = 0xFF;
+        } while (--k->cacheSize != 0);
+        k->cache = k->low >> 24;
+    }
+    ++k->cacheSize;
+    k->low = (k->low & 0x00FFFFFFu) << 8;
+}
+
+static void putByte(CODER *k,unsigned char b)
+{
+    if (k->size == k->capacity)
+    {
+        k->capacity *= 2;
+        k->bytes = realloc(k->bytes,k->capacity);
+        assert(k->bytes != 0);
+    }
+    k->bytes[k->size++] = b;
+}
+
+static void finishCoder(CODER *k)
+{
+    for (int i = 0; i < 5; ++i) {shiftLow(k);}
+}
@@ -0,0 +1,27 @@
+#ifndef __ARCH_INCLUDED__
+#define __ARCH_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+#define ARCHIVE_BLOCK_ROWS 64
+
+typedef struct archive ARCHIVE;
+
+extern ARCHIVE *openARCHIVE(FILE *fp);
+extern ARCHIVE *openARCHIVEheader(FILE *fp);
+extern int  getARCHIVErows(ARCHIVE *a);
+extern int  getARCHIVEcols(ARCHIVE *a);
+extern int  getARCHIVEblockRows(ARCHIVE *a);
+extern int  getARCHIVEblocks(ARCHIVE *a);
+extern long getARCHIVEstart(ARCHIVE *a);
+extern long getARCHIVEgoal(ARCHIVE *a);
+extern int  nextARCHIVEblock(ARCHIVE *a,unsigned char *walls);
+extern int  seekARCHIVEblock(ARCHIVE *a,int block);
+extern void closeARCHIVE(ARCHIVE *a);
+extern long writeARCHIVE(GRID *g,int blockRows,FILE *fp);
+
+extern int  packARCHIVE(FILE *readFile,FILE *writeFile);
+extern int  unpackARCHIVE(FILE *readFile,FILE *writeFile);
+
+#endif
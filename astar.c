@@ -0,0 +1,363 @@
+/***************************************************************************
+ * This module finds shortest paths from the entrance to the exit with     *
+ * A* search, using the Manhattan distance to the exit as the heuristic.   *
+ * It is meant for braided mazes, which have loops and open rooms, where   *
+ * a breadth first search has to look at most of the maze before it gets   *
+ * to the exit.                                                            *
+ *                                                                         *
+ * jpsGRID is jump point search adapted to walls on a four connected grid. *
+ * Among the shortest paths it only follows the ones that move vertically  *
+ * as early as they can, so a path moving horizontally only turns where    *
+ * the wall layout forces it to. Straight runs are jumped over without     *
+ * queueing the cells along them, which skips the many equally short ways  *
+ * across an open room as well as plain corridors. A horizontal run stops  *
+ * at a cell with a forced turn, and a vertical run stops at a cell where  *
+ * a horizontal run would stop somewhere. Both stop at the exit.           *
+ *                                                                         *
+ * Both searches leave the values of the cells on the path set to their    *
+ * step number mod 10 and all other values set to -1, and return the       *
+ * number of steps, or -1 if the exit can't be reached.                    *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "astar.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+/* The low four bits of a cell's state hold the directions it was reached
+   from by an equally short path; START allows every direction. */
+#define START  0x10
+#define CLOSED 0x20
+
+typedef struct search
+{
+    GRID *g;
+    int rows;
+    int cols;
+    int start;
+    int goal;
+    long *dist;             /* steps from the entrance, or LONG_MAX */
+    int *parent;            /* previous cell, or jump point, on the path */
+    unsigned char *state;
+    long *heapKey;          /* binary heap of cells keyed by dist + estimate */
+    int *heapCell;
+    long heapSize;
+    long heapCap;
+} SEARCH;
+
+static int RowStep[4] = {-1,0,0,1};
+static int ColStep[4] = {0,-1,1,0};
+
+static SEARCH *newSEARCH(GRID *g);
+static void freeSEARCH(SEARCH *s);
+static void relax(SEARCH *s,int cell,long d,int from,int dir);
+static void pushHeap(SEARCH *s,int cell);
+static int popHeap(SEARCH *s);
+static int isOpen(SEARCH *s,int row,int col,int wall);
+static int isForced(SEARCH *s,int row,int col,int dir,int side);
+static int jumpAcross(SEARCH *s,int row,int col,int dir);
+static int jumpUpDown(SEARCH *s,int row,int col,int dir);
+static long markPath(SEARCH *s);
+
+long astarGRID(GRID *g,long *expanded)
+{
+    SEARCH *s = newSEARCH(g);
+    int goal = s->goal;
+    long count = 0;
+
+    relax(s,s->start,0,-1,0);
+    while (s->heapSize > 0)
+    {
+        int cell = popHeap(s);
+        if (s->state[cell] & CLOSED) {continue;}
+        s->state[cell] |= CLOSED;
+        ++count;
+        if (cell == goal) {break;}
+
+        int row = cell / s->cols, col = cell % s->cols;
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (!isOpen(s,row,col,wall)) {continue;}
+            int next = cell + RowStep[wall] * s->cols + ColStep[wall];
+            if (!(s->state[next] & CLOSED))
+                relax(s,next,s->dist[cell] + 1,cell,wall);
+        }
+    }
+
+    if (expanded != 0) {*expanded = count;}
+    long steps = markPath(s);
+    freeSEARCH(s);
+    return steps;
+}
+
+long jpsGRID(GRID *g,long *expanded)
+{
+    SEARCH *s = newSEARCH(g);
+    int goal = s->goal;
+    long count = 0;
+
+    relax(s,s->start,0,-1,0);
+    s->state[s->start] = START;
+    while (s->heapSize > 0)
+    {
+        int cell = popHeap(s);
+        if (s->state[cell] & CLOSED) {continue;}
+        s->state[cell] |= CLOSED;
+        ++count;
+        if (cell == goal) {break;}
+
+        /* Work out which directions a shortest path may leave in, given
+           the directions it arrived from. */
+        int row = cell / s->cols, col = cell % s->cols;
+        int from = s->state[cell];
+        int allowed = 0;
+        if (from & START) {allowed = 0xF;}
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            if (!(from & (1 << dir))) {continue;}
+            if (dir == 0 || dir == 3) {allowed |= (1 << dir) | 0x6;}
+            else
+            {
+                allowed |= 1 << dir;
+                if (isForced(s,row,col,dir,0)) {allowed |= 1 << 0;}
+                if (isForced(s,row,col,dir,3)) {allowed |= 1 << 3;}
+            }
+        }
+
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            if (!(allowed & (1 << dir)) || !isOpen(s,row,col,dir)) {continue;}
+            int r = row + RowStep[dir], c = col + ColStep[dir];
+            int next = (dir == 0 || dir == 3) ? jumpUpDown(s,r,c,dir)
+                                              : jumpAcross(s,r,c,dir);
+            if (next == -1) {continue;}
+            long d = s->dist[cell] + labs(next / s->cols - row)
+                                   + labs(next % s->cols - col);
+            relax(s,next,d,cell,dir);
+        }
+    }
+
+    if (expanded != 0) {*expanded = count;}
+    long steps = markPath(s);
+    freeSEARCH(s);
+    return steps;
+}
+
+long solveASTAR(FILE *readFile,FILE *writeFile)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return -1;}
+    long steps = astarGRID(g,0);
+    writeGRID(g,writeFile);
+    freeGRID(g);
+    return steps;
+}
+
+long solveJPS(FILE *readFile,FILE *writeFile)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return -1;}
+    long steps = jpsGRID(g,0);
+    writeGRID(g,writeFile);
+    freeGRID(g);
+    return steps;
+}
+
+static SEARCH *newSEARCH(GRID *g)
+{
+    SEARCH *s = malloc(sizeof(SEARCH));
+    assert(s != 0);
+    long size = (long)getGRIDrows(g) * getGRIDcols(g);
+
+    s->g = g;
+    s->rows = getGRIDrows(g);
+    s->cols = getGRIDcols(g);
+    s->start = getGRIDstart(g);
+    s->goal = getGRIDgoal(g);
+    s->dist = malloc(sizeof(long) * size);
+    s->parent = malloc(sizeof(int) * size);
+    s->state = calloc(size,1);
+    s->heapCap = 1024;
+    s->heapSize = 0;
+    s->heapKey = malloc(sizeof(long) * s->heapCap);
+    s->heapCell = malloc(sizeof(int) * s->heapCap);
+    assert(s->dist != 0 && s->parent != 0 && s->state != 0);
+    assert(s->heapKey != 0 && s->heapCell != 0);
+
+    for (long i = 0; i < size; ++i) {s->dist[i] = LONG_MAX;}
+    return s;
+}
+
+static void freeSEARCH(SEARCH *s)
+{
+    free(s->dist);
+    free(s->parent);
+    free(s->state);
+    free(s->heapKey);
+    free(s->heapCell);
+    free(s);
+}
+
+/* Records a path of length d to a cell, entered moving in direction dir.
+   A path as short as the best one so far only adds its direction, and
+   reopens the cell if that lets it be left in more directions. */
+static void relax(SEARCH *s,int cell,long d,int from,int dir)
+{
+    if (d < s->dist[cell])
+    {
+        s->dist[cell] = d;
+        s->parent[cell] = from;
+        s->state[cell] = 1 << dir;
+        pushHeap(s,cell);
+    }
+    else if (d == s->dist[cell] && !(s->state[cell] & (1 << dir)))
+    {
+        s->state[cell] |= 1 << dir;
+        if (s->state[cell] & CLOSED)
+        {
+            s->state[cell] &= ~CLOSED;
+            pushHeap(s,cell);
+        }
+    }
+}
+
+/* Cells are keyed by the length of the path through them. Ties go to the
+   cell furthest along, which is the one closest to the exit. Cells whose
+   key improves are pushed again, and the stale copies skipped later. */
+static void pushHeap(SEARCH *s,int cell)
+{
+    if (s->heapSize == s->heapCap)
+    {
+        s->heapCap *= 2;
+        s->heapKey = realloc(s->heapKey,sizeof(long) * s->heapCap);
+        s->heapCell = realloc(s->heapCell,sizeof(int) * s->heapCap);
+        assert(s->heapKey != 0 && s->heapCell != 0);
+    }
+
+    long estimate = labs(s->goal / s->cols - cell / s->cols)
+                  + labs(s->goal % s->cols - cell % s->cols);
+    long key = (s->dist[cell] + estimate) * 2 * (s->rows + s->cols) + estimate;
+
+    long i = s->heapSize++;
+    while (i > 0 && s->heapKey[(i-1)/2] > key)
+    {
+        s->heapKey[i] = s->heapKey[(i-1)/2];
+        s->heapCell[i] = s->heapCell[(i-1)/2];
+        i = (i-1)/2;
+    }
+    s->heapKey[i] = key;
+    s->heapCell[i] = cell;
+}
+
+static int popHeap(SEARCH *s)
+{
+    int top = s->heapCell[0];
+    long key = s->heapKey[--s->heapSize];
+    int cell = s->heapCell[s->heapSize];
+
+    long i = 0;
+    while (2*i + 1 < s->heapSize)
+    {
+        long child = 2*i + 1;
+        if (child + 1 < s->heapSize && s->heapKey[child+1] < s->heapKey[child])
+            ++child;
+        if (s->heapKey[child] >= key) {break;}
+        s->heapKey[i] = s->heapKey[child];
+        s->heapCell[i] = s->heapCell[child];
+        i = child;
+    }
+    s->heapKey[i] = key;
+    s->heapCell[i] = cell;
+    return top;
+}
+
+/* Returns 1 if a cell can be left through the given wall. The entrance and
+   exit lead out of the maze, so they don't count. */
+static int isOpen(SEARCH *s,int row,int col,int wall)
+{
+    int r = row + RowStep[wall], c = col + ColStep[wall];
+    if (r < 0 || r >= s->rows || c < 0 || c >= s->cols) {return 0;}
+    return !getGRIDwall(s->g,row,col,wall);
+}
+
+/* A path entering a cell horizontally that then turns up or down could
+   instead have turned one cell earlier and gone across. That path is just
+   as short and turns vertically sooner, so it is preferred unless the
+   walls block it, in which case the turn is forced. */
+static int isForced(SEARCH *s,int row,int col,int dir,int side)
+{
+    if (!isOpen(s,row,col,side)) {return 0;}
+    int prev = col - ColStep[dir];
+    return !(isOpen(s,row,prev,side)
+             && isOpen(s,row + RowStep[side],prev,dir));
+}
+
+/* Moves horizontally from a cell just entered, returning the first cell
+   that is the exit or has a forced turn, or -1 if a wall is reached. */
+static int jumpAcross(SEARCH *s,int row,int col,int dir)
+{
+    int goal = s->goal;
+    while (1)
+    {
+        int cell = row * s->cols + col;
+        if (cell == goal) {return cell;}
+        if (isForced(s,row,col,dir,0) || isForced(s,row,col,dir,3))
+            return cell;
+        if (!isOpen(s,row,col,dir)) {return -1;}
+        col += ColStep[dir];
+    }
+}
+
+/* Moves vertically from a cell just entered, returning the first cell that
+   is the exit or that a horizontal jump would leave from, or -1 if a wall
+   is reached. */
+static int jumpUpDown(SEARCH *s,int row,int col,int dir)
+{
+    int goal = s->goal;
+    while (1)
+    {
+        int cell = row * s->cols + col;
+        if (cell == goal) {return cell;}
+        for (int side = 1; side <= 2; ++side)
+            if (isOpen(s,row,col,side)
+                && jumpAcross(s,row,col + ColStep[side],side) != -1)
+                return cell;
+        if (!isOpen(s,row,col,dir)) {return -1;}
+        row += RowStep[dir];
+    }
+}
+
+/* Writes step numbers along the path to the exit, filling in the straight
+   runs between jump points, and clears every other value. */
+static long markPath(SEARCH *s)
+{
+    for (int i = 0; i < s->rows; ++i)
+        for (int j = 0; j < s->cols; ++j)
+            setGRIDval(s->g,i,j,-1);
+
+    int goal = s->goal;
+    if (s->dist[goal] == LONG_MAX) {return -1;}
+
+    int cell = goal;
+    while (cell != s->start)
+    {
+        int prev = s->parent[cell];
+        int row = cell / s->cols, col = cell % s->cols;
+        int dr = (prev / s->cols > row) - (prev / s->cols < row);
+        int dc = (prev % s->cols > col) - (prev % s->cols < col);
+        long d = s->dist[cell];
+        while (row * s->cols + col != prev)
+        {
+            setGRIDval(s->g,row,col,d-- % 10);
+            row += dr;
+            col += dc;
+        }
+        cell = prev;
+    }
+    setGRIDval(s->g,s->start / s->cols,s->start % s->cols,0);
+    return s->dist[goal];
+}
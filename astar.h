@@ -0,0 +1,12 @@
+#ifndef __ASTAR_INCLUDED__
+#define __ASTAR_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+extern long astarGRID(GRID *g,long *expanded);
+extern long jpsGRID(GRID *g,long *expanded);
+extern long solveASTAR(FILE *readFile,FILE *writeFile);
+extern long solveJPS(FILE *readFile,FILE *writeFile);
+
+#endif
@@ -0,0 +1,212 @@
+/***************************************************************************
+ * This module generates mazes with the same depth-first search as the     *
+ * maze class, but without a stack. When the search moves into a new cell  *
+ * it stores the direction back to the cell it came from in the grid. A    *
+ * cell is unvisited exactly when all four of its walls still stand, so    *
+ * once a cell has no unvisited neighbors the search backtracks by         *
+ * following the stored direction. The grid is the only memory used, one  *
+ * byte per cell, no matter how deep the search goes.                      *
+ *                                                                         *
+ * The search can also be run a few moves at a time, so that a program     *
+ * drawing the maze as it grows never waits on a whole maze. Between calls *
+ * to stepBACKTRACK the generator keeps its place and its own random()     *
+ * state, which it swaps in only while it runs, so other users of random() *
+ * in between don't change the maze. After each call it lists the cells    *
+ * whose walls changed, and the cells on its stack can be walked from the  *
+ * current cell back to the entrance through the stored directions.        *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "backtrack.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+// Necissary for random(), initstate(), and setstate() to work.
+long int random(void);
+char *initstate(unsigned int seed,char *state,size_t n);
+char *setstate(char *state);
+
+/* The size of the default random() state, so that a generator's own state
+   gives the same numbers srandom() would. */
+#define STATE_BYTES 128
+
+struct backtrack
+{
+    GRID *g;
+    int row;
+    int col;
+    long depth;
+    int done;
+    char state[STATE_BYTES];
+    /* Cells whose walls changed in the last call to stepBACKTRACK. */
+    long *changed;
+    long changedCount;
+    long changedCapacity;
+};
+
+static int  isUnvisited(GRID *g,int row,int col,int wall);
+static void step(int *row,int *col,int wall);
+static void addChanged(BACKTRACK *b,int row,int col);
+
+GRID *generateBACKTRACK(int rows,int cols,int randSeed)
+{
+    BACKTRACK *b = newBACKTRACK(rows,cols,randSeed);
+    while (!isBACKTRACKdone(b)) {stepBACKTRACK(b,rows * (long)cols);}
+    GRID *g = getBACKTRACKgrid(b);
+    freeBACKTRACK(b);
+    return g;
+}
+
+/* Starts a generator at the entrance of a grid of walls, with the
+   entrance already open. */
+BACKTRACK *newBACKTRACK(int rows,int cols,int randSeed)
+{
+    assert(rows > 0 && cols > 0);
+    BACKTRACK *b = malloc(sizeof(BACKTRACK));
+    assert(b != 0);
+    b->g = newGRID(rows,cols);
+    b->row = 0;
+    b->col = 0;
+    b->depth = 0;
+    b->done = 0;
+    b->changed = 0;
+    b->changedCount = 0;
+    b->changedCapacity = 0;
+    setstate(initstate(randSeed,b->state,STATE_BYTES));
+
+    /* Opening the entrance marks the first cell as visited. */
+    removeGRIDwall(b->g,0,0,1);
+    return b;
+}
+
+/* Makes at most moves moves, each one carving into a new cell, stepping
+   back a cell, or, back at the entrance, opening the exit, which ends the
+   search. Returns the number of moves made. */
+long stepBACKTRACK(BACKTRACK *b,long moves)
+{
+    GRID *g = b->g;
+    int rows = getGRIDrows(g), cols = getGRIDcols(g);
+    char *outside = setstate(b->state);
+    b->changedCount = 0;
+
+    long made = 0;
+    for (; made < moves && !b->done; ++made)
+    {
+        int choices[4];
+        int count = 0;
+        for (int wall = 0; wall < 4; ++wall)
+            if (isUnvisited(g,b->row,b->col,wall)) {choices[count++] = wall;}
+
+        if (count)
+        {
+            int wall = choices[random() % count];
+            removeGRIDwall(g,b->row,b->col,wall);
+            addChanged(b,b->row,b->col);
+            step(&b->row,&b->col,wall);
+            setGRIDdir(g,b->row,b->col,3 - wall);
+            addChanged(b,b->row,b->col);
+            ++b->depth;
+        }
+        else if (b->row == 0 && b->col == 0)
+        {
+            removeGRIDwall(g,rows-1,cols-1,2);
+            addChanged(b,rows-1,cols-1);
+            b->done = 1;
+        }
+        else
+        {
+            step(&b->row,&b->col,getGRIDdir(g,b->row,b->col));
+            --b->depth;
+        }
+    }
+
+    setstate(outside);
+    return made;
+}
+
+int isBACKTRACKdone(BACKTRACK *b) {return b->done;}
+
+long getBACKTRACKcell(BACKTRACK *b)
+{
+    return (long)b->row * getGRIDcols(b->g) + b->col;
+}
+
+/* Sets cells to the cells whose walls changed in the last call to
+   stepBACKTRACK, each as row * cols + col, and returns their number. A
+   cell may be listed more than once. The list is good until the next
+   call. */
+long getBACKTRACKchanged(BACKTRACK *b,long **cells)
+{
+    *cells = b->changed;
+    return b->changedCount;
+}
+
+/* The number of cells on the stack below the current cell. */
+long getBACKTRACKdepth(BACKTRACK *b) {return b->depth;}
+
+/* Fills cells with at most max cells of the stack, the current cell first
+   and then each cell beneath it, and returns their number. */
+long traceBACKTRACKstack(BACKTRACK *b,long *cells,long max)
+{
+    int row = b->row, col = b->col, cols = getGRIDcols(b->g);
+    long count = 0;
+    for (long k = 0; k <= b->depth && count < max; ++k)
+    {
+        cells[count++] = (long)row * cols + col;
+        if (k < b->depth) {step(&row,&col,getGRIDdir(b->g,row,col));}
+    }
+    return count;
+}
+
+GRID *getBACKTRACKgrid(BACKTRACK *b) {return b->g;}
+
+/* Frees the generator but not its grid, which the caller frees once done
+   with it. */
+void freeBACKTRACK(BACKTRACK *b)
+{
+    free(b->changed);
+    free(b);
+}
+
+void createBACKTRACK(int rows,int cols,int randSeed,FILE *fp)
+{
+    GRID *g = generateBACKTRACK(rows,cols,randSeed);
+    writeGRID(g,fp);
+    freeGRID(g);
+}
+
+/* Returns 1 if the cell through the given wall is inside the grid and has
+   not been visited yet. */
+static int isUnvisited(GRID *g,int row,int col,int wall)
+{
+    if (wall == 0 && row == 0) {return 0;}
+    if (wall == 1 && col == 0) {return 0;}
+    if (wall == 2 && col == getGRIDcols(g) - 1) {return 0;}
+    if (wall == 3 && row == getGRIDrows(g) - 1) {return 0;}
+
+    step(&row,&col,wall);
+    return getGRIDwalls(g,row,col) == 0xF;
+}
+
+static void addChanged(BACKTRACK *b,int row,int col)
+{
+    if (b->changedCount == b->changedCapacity)
+    {
+        b->changedCapacity = b->changedCapacity ? b->changedCapacity * 2 : 64;
+        b->changed = realloc(b->changed,sizeof(long) * b->changedCapacity);
+        assert(b->changed != 0);
+    }
+    b->changed[b->changedCount++] = (long)row * getGRIDcols(b->g) + col;
+}
+
+/* Moves row and col to the cell through the given wall. */
+static void step(int *row,int *col,int wall)
+{
+    if (wall == 0)      {--*row;}
+    else if (wall == 1) {--*col;}
+    else if (wall == 2) {++*col;}
+    else                {++*row;}
+}
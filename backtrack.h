@@ -0,0 +1,22 @@
+#ifndef __BACKTRACK_INCLUDED__
+#define __BACKTRACK_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+typedef struct backtrack BACKTRACK;
+
+extern GRID *generateBACKTRACK(int rows,int cols,int randSeed);
+extern void  createBACKTRACK(int rows,int cols,int randSeed,FILE *fp);
+
+extern BACKTRACK *newBACKTRACK(int rows,int cols,int randSeed);
+extern long  stepBACKTRACK(BACKTRACK *b,long moves);
+extern int   isBACKTRACKdone(BACKTRACK *b);
+extern long  getBACKTRACKcell(BACKTRACK *b);
+extern long  getBACKTRACKchanged(BACKTRACK *b,long **cells);
+extern long  getBACKTRACKdepth(BACKTRACK *b);
+extern long  traceBACKTRACKstack(BACKTRACK *b,long *cells,long max);
+extern GRID *getBACKTRACKgrid(BACKTRACK *b);
+extern void  freeBACKTRACK(BACKTRACK *b);
+
+#endif
@@ -0,0 +1,293 @@
+/***************************************************************************
+ * This module generates and solves small mazes, up to 64 by 64, without   *
+ * touching the heap. Each row of passages is a 64 bit word, so the whole  *
+ * maze is 1 KB and sits on the stack along with everything the kernels    *
+ * need. It is meant for making and solving many small mazes quickly,      *
+ * where the mallocs of the maze class cost more than the maze itself.     *
+ *                                                                         *
+ * generateBBOARD is the same depth-first search as the maze class, with   *
+ * the visited cells kept as bits and the stack as a fixed array. It uses  *
+ * its own xorshift generator in place of random() so each call depends    *
+ * only on its seed and nothing is shared between threads.                 *
+ *                                                                         *
+ * pathBBOARD is a breadth first search done as a flood fill. Each level   *
+ * of the search is a set of bits per row, and the next level is found a   *
+ * whole row at a time by shifting the bits across the passages. Only the  *
+ * rows the search has reached are touched on each level. The distance to  *
+ * each cell is kept so the path can be traced back from the exit.         *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "bboard.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+
+static uint64_t nextRandom(uint64_t *state);
+
+static const int RowStep[4] = {-1,0,0,1};
+static const int ColStep[4] = {0,-1,1,0};
+static const int PassRow[4] = {-1,0,0,0};
+static const int PassCol[4] = {0,-1,0,0};
+
+/* Pick[m][k] is the kth wall whose bit is set in the mask m. */
+static const unsigned char Pick[16][4] =
+{
+    {0,0,0,0}, {0,0,0,0}, {1,0,0,0}, {0,1,0,0},
+    {2,0,0,0}, {0,2,0,0}, {1,2,0,0}, {0,1,2,0},
+    {3,0,0,0}, {0,3,0,0}, {1,3,0,0}, {0,1,3,0},
+    {2,3,0,0}, {0,2,3,0}, {1,2,3,0}, {0,1,2,3},
+};
+
+void generateBBOARD(BBOARD *b,int rows,int cols,int randSeed)
+{
+    assert(rows > 0 && rows <= BBOARD_MAX);
+    assert(cols > 0 && cols <= BBOARD_MAX);
+
+    b->rows = rows;
+    b->cols = cols;
+    /* Bits of the cells not yet visited. Rows -1 and rows are empty, and
+       so are the bits past the last column, so the edges need no checks. */
+    uint64_t fresh[BBOARD_MAX + 2];
+    uint64_t *unvisited = fresh + 1;
+    uint64_t all = cols == 64 ? ~(uint64_t)0 : ((uint64_t)1 << cols) - 1;
+    /* Cells on the stack are row * 64 + col, to save a division. */
+    uint16_t stack[BBOARD_MAX * BBOARD_MAX];
+    uint64_t *passages[2] = {b->down,b->right};
+    unvisited[-1] = unvisited[rows] = 0;
+    for (int i = 0; i < rows; ++i)
+    {
+        b->right[i] = 0;
+        b->down[i] = 0;
+        unvisited[i] = all;
+    }
+
+    uint64_t state = ((uint64_t)(unsigned int)randSeed * 0x9E3779B97F4A7C15ull
+        + 0x2545F4914F6CDD1Dull) | 1;
+    int top = 0;
+    stack[top++] = 0;
+    unvisited[0] &= ~(uint64_t)1;
+
+    while (top > 0)
+    {
+        int row = stack[top-1] >> 6, col = stack[top-1] & 63;
+
+        // One bit for each wall that leads to an unvisited cell.
+        int open = (unvisited[row-1] >> col & 1)
+            | ((unvisited[row] << 1) >> col & 1) << 1
+            | ((unvisited[row] >> 1) >> col & 1) << 2
+            | (unvisited[row+1] >> col & 1) << 3;
+        if (open == 0)
+        {
+            --top;
+            continue;
+        }
+
+        int count = (0x4332322132212110ull >> (open * 4)) & 0xF;
+        int wall = Pick[open][(nextRandom(&state) * count) >> 32];
+        // The passage is stored in the upper or left cell of the two.
+        passages[wall == 1 || wall == 2][row + PassRow[wall]] |=
+            (uint64_t)1 << (col + PassCol[wall]);
+        row += RowStep[wall];
+        col += ColStep[wall];
+        unvisited[row] &= ~((uint64_t)1 << col);
+        stack[top++] = row << 6 | col;
+    }
+}
+
+/* Sets the bits of the cells on a shortest path from the top left cell to
+   the bottom right one and returns its number of steps, or -1 if there is
+   none. */
+int pathBBOARD(BBOARD *b,uint64_t *path)
+{
+    int rows = b->rows, cols = b->cols;
+    uint64_t seen[BBOARD_MAX], front[BBOARD_MAX], next[BBOARD_MAX];
+    uint16_t dist[BBOARD_MAX * BBOARD_MAX];
+    for (int i = 0; i < rows; ++i)
+    {
+        seen[i] = 0;
+        front[i] = 0;
+        next[i] = 0;
+        path[i] = 0;
+    }
+
+    int goalRow = rows - 1, goalCol = cols - 1;
+    uint64_t goalBit = (uint64_t)1 << goalCol;
+    seen[0] = front[0] = 1;
+    dist[0] = 0;
+
+    // Rows [lo,hi] hold the frontier.
+    int lo = 0, hi = 0, level = 0;
+    while (!(seen[goalRow] & goalBit))
+    {
+        int nlo = rows, nhi = -1;
+        for (int r = lo; r <= hi; ++r)
+        {
+            uint64_t f = front[r];
+            if (!f) {continue;}
+            next[r] |= (f & b->right[r]) << 1 | (f >> 1 & b->right[r]);
+            if (r > 0) {next[r-1] |= f & b->down[r-1];}
+            if (r < rows - 1) {next[r+1] |= f & b->down[r];}
+        }
+        ++level;
+
+        int lower = lo > 0 ? lo - 1 : 0;
+        int upper = hi < rows - 1 ? hi + 1 : hi;
+        for (int r = lower; r <= upper; ++r)
+        {
+            uint64_t n = next[r] & ~seen[r];
+            next[r] = 0;
+            front[r] = n;
+            if (!n) {continue;}
+            seen[r] |= n;
+            if (r < nlo) {nlo = r;}
+            if (r > nhi) {nhi = r;}
+            while (n)
+            {
+                int c = __builtin_ctzll(n);
+                dist[r * cols + c] = level;
+                n &= n - 1;
+            }
+        }
+        if (nhi < 0) {return -1;}
+        lo = nlo;
+        hi = nhi;
+    }
+
+    /* Walk back from the exit to any neighbor one step closer. Only the
+       distances of seen cells have been set. */
+    int row = goalRow, col = goalCol;
+    int steps = dist[row * cols + col];
+    path[row] |= goalBit;
+    for (int d = steps - 1; d >= 0; --d)
+    {
+        uint64_t bit = (uint64_t)1 << col;
+        if (row > 0 && (b->down[row-1] & seen[row-1] & bit) &&
+            dist[(row-1) * cols + col] == d) {--row;}
+        else if (col > 0 && (b->right[row] & seen[row] & bit >> 1) &&
+            dist[row * cols + col-1] == d) {--col;}
+        else if (col < cols - 1 && (b->right[row] & bit) &&
+            (seen[row] & bit << 1) && dist[row * cols + col+1] == d) {++col;}
+        else {++row;}
+        path[row] |= (uint64_t)1 << col;
+    }
+    return steps;
+}
+
+/* Writes the maze in the same format as the maze class. If path is given,
+   the cells on it are numbered by step mod 10. */
+void writeBBOARD(BBOARD *b,const uint64_t *path,FILE *fp)
+{
+    int rows = b->rows, cols = b->cols;
+    int8_t value[BBOARD_MAX * BBOARD_MAX];
+    for (int i = 0; i < rows * cols; ++i) {value[i] = -1;}
+
+    /* Number the path by following it from the entrance. */
+    if (path && (path[0] & 1))
+    {
+        int row = 0, col = 0, prev = -1, step = 0;
+        while (1)
+        {
+            int cell = row * cols + col;
+            value[cell] = step++ % 10;
+            uint64_t bit = (uint64_t)1 << col;
+            int r = row, c = col;
+            if (row > 0 && (b->down[row-1] & bit) && (path[row-1] & bit) &&
+                cell - cols != prev) {--r;}
+            else if (col > 0 && (b->right[row] & bit >> 1) &&
+                (path[row] & bit >> 1) && cell - 1 != prev) {--c;}
+            else if (col < cols - 1 && (b->right[row] & bit) &&
+                (path[row] & bit << 1) && cell + 1 != prev) {++c;}
+            else if (row < rows - 1 && (b->down[row] & bit) &&
+                (path[row+1] & bit) && cell + cols != prev) {++r;}
+            else {break;}
+            prev = cell;
+            row = r;
+            col = c;
+        }
+    }
+
+    fprintf(fp,"%d %d\n",rows,cols);
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            int left = j == 0 ? i != 0 : !(b->right[i] >> (j-1) & 1);
+            fprintf(fp,"%d %d ",left,value[i * cols + j]);
+        }
+        fprintf(fp,"%d\n",i != rows - 1);
+
+        if (i < rows - 1)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                fprintf(fp,"%d",!(b->down[i] >> j & 1));
+                if (j < cols - 1) {fprintf(fp," ");}
+            }
+            fprintf(fp,"\n");
+        }
+    }
+}
+
+/* Returns 0 if the file doesn't hold a maze of at most 64 by 64 with its
+   entrance and exit in the corners. */
+int readBBOARD(BBOARD *b,FILE *fp)
+{
+    GRID *g = readGRID(fp);
+    if (g == 0) {return 0;}
+    int rows = getGRIDrows(g), cols = getGRIDcols(g);
+    if (rows < 1 || rows > BBOARD_MAX || cols < 1 || cols > BBOARD_MAX ||
+        getGRIDstart(g) != 0 || getGRIDgoal(g) != (long)rows * cols - 1)
+    {
+        freeGRID(g);
+        return 0;
+    }
+
+    b->rows = rows;
+    b->cols = cols;
+    for (int i = 0; i < rows; ++i)
+    {
+        b->right[i] = 0;
+        b->down[i] = 0;
+        for (int j = 0; j < cols; ++j)
+        {
+            uint64_t bit = (uint64_t)1 << j;
+            if (j < cols - 1 && !getGRIDwall(g,i,j,2)) {b->right[i] |= bit;}
+            if (i < rows - 1 && !getGRIDwall(g,i,j,3)) {b->down[i] |= bit;}
+        }
+    }
+    freeGRID(g);
+    return 1;
+}
+
+void createBBOARD(int rows,int cols,int randSeed,FILE *fp)
+{
+    BBOARD b;
+    generateBBOARD(&b,rows,cols,randSeed);
+    writeBBOARD(&b,0,fp);
+}
+
+/* Returns the number of steps, -1 if there is no path, or -2 if the maze
+   can't be read or is too big. */
+long solveBBOARD(FILE *readFile,FILE *writeFile)
+{
+    BBOARD b;
+    uint64_t path[BBOARD_MAX];
+    if (!readBBOARD(&b,readFile)) {return -2;}
+    int steps = pathBBOARD(&b,path);
+    writeBBOARD(&b,steps < 0 ? 0 : path,writeFile);
+    return steps;
+}
+
+/* xorshift64*, which is fast and good enough for picking walls. */
+static uint64_t nextRandom(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return (x * 0x2545F4914F6CDD1Dull) >> 32;
+}
@@ -0,0 +1,29 @@
+#ifndef __BBOARD_INCLUDED__
+#define __BBOARD_INCLUDED__
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define BBOARD_MAX 64
+
+/* Unlike the other mazes this one is not hidden behind a pointer, so it
+   can live on the caller's stack. Bit c of right[r] is set when the cell
+   at row r and column c has a passage to its right, and bit c of down[r]
+   when it has one below. */
+typedef struct bboard
+{
+    int rows;
+    int cols;
+    uint64_t right[BBOARD_MAX];
+    uint64_t down[BBOARD_MAX];
+} BBOARD;
+
+extern void generateBBOARD(BBOARD *b,int rows,int cols,int randSeed);
+extern int  pathBBOARD(BBOARD *b,uint64_t *path);
+extern void writeBBOARD(BBOARD *b,const uint64_t *path,FILE *fp);
+extern int  readBBOARD(BBOARD *b,FILE *fp);
+
+extern void createBBOARD(int rows,int cols,int randSeed,FILE *fp);
+extern long solveBBOARD(FILE *readFile,FILE *writeFile);
+
+#endif
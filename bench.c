@@ -0,0 +1,419 @@
+/***************************************************************************
+ * This program benchmarks the maze generators and solvers. Each case is   *
+ * run in its own child process so the peak memory reported for it is not  *
+ * polluted by the cases run before it. For every case the throughput in   *
+ * cells per second and the peak resident memory are printed. Mazes are    *
+ * written to /dev/null so file I/O costs the same for every case. Solver  *
+ * cases first build their input maze in a separate child process, so      *
+ * neither the time nor the memory of building it is counted. Cases with   *
+ * a thread count read their maze before the clock starts, so only the     *
+ * search itself is timed and its scaling with threads can be seen.        *
+ * After the cases, the size of a Kruskal maze as text and as a compressed *
+ * archive are printed.                                                    *
+ *                                                                         *
+ * Usage: mbench [ROWS COLS]        (default 1000 x 1000)                  *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "maze.h"
+#include "backtrack.h"
+#include "kruskal.h"
+#include "wilson.h"
+#include "grid.h"
+#include "dial.h"
+#include "braid.h"
+#include "astar.h"
+#include "nmaze.h"
+#include "tgrid.h"
+#include "stats.h"
+#include "pbfs.h"
+#include "flood.h"
+#include "bboard.h"
+#include "smaze.h"
+#include "arch.h"
+#include "route.h"
+#include "raster.h"
+#include "svg.h"
+
+typedef struct benchcase
+{
+    char *name;
+    /* Writes the input maze for run, or is 0 for generators. */
+    void (*setup)(int rows,int cols,FILE *in);
+    void (*run)(int rows,int cols,FILE *in,FILE *out);
+    /* Threads for the parallel search, or 0 for single threaded cases. */
+    int threads;
+} BENCHCASE;
+
+static void runDFS(int rows,int cols,FILE *in,FILE *out);
+static void runBACKTRACK(int rows,int cols,FILE *in,FILE *out);
+static void runSTEPPED(int rows,int cols,FILE *in,FILE *out);
+static void runKRUSKAL(int rows,int cols,FILE *in,FILE *out);
+static void runWILSON(int rows,int cols,FILE *in,FILE *out);
+static void runHYBRID(int rows,int cols,FILE *in,FILE *out);
+static void runNMAZE(int rows,int cols,FILE *in,FILE *out);
+static void runSQUARE(int rows,int cols,FILE *in,FILE *out);
+static void runTORUS(int rows,int cols,FILE *in,FILE *out);
+static void runHEX(int rows,int cols,FILE *in,FILE *out);
+static void runBFS(int rows,int cols,FILE *in,FILE *out);
+static void runDIJKSTRA(int rows,int cols,FILE *in,FILE *out);
+static void runASTAR(int rows,int cols,FILE *in,FILE *out);
+static void runJPS(int rows,int cols,FILE *in,FILE *out);
+static void runSTATS(int rows,int cols,FILE *in,FILE *out);
+static void runPBFS(int rows,int cols,FILE *in,FILE *out);
+static void runBBOARD16(int rows,int cols,FILE *in,FILE *out);
+static void runBBOARD64(int rows,int cols,FILE *in,FILE *out);
+static void runBBOARD(int size,long cells,FILE *out);
+static void runPACKED(int rows,int cols,FILE *in,FILE *out);
+static void runROUTE(int rows,int cols,FILE *in,FILE *out);
+static void runIMAGE(int rows,int cols,FILE *in,FILE *out);
+static void runSVG(int rows,int cols,FILE *in,FILE *out);
+static void makePACKED(int rows,int cols,FILE *in);
+static void runARCHIVE(int rows,int cols,FILE *in,FILE *out);
+static void runUNARCHIVE(int rows,int cols,FILE *in,FILE *out);
+static void makeKRUSKAL(int rows,int cols,FILE *in);
+static void makeARCHIVE(int rows,int cols,FILE *in);
+static void printRatio(int rows,int cols);
+static void makeWEIGHTED(int rows,int cols,FILE *in);
+static void makeBRAIDED(int rows,int cols,FILE *in);
+static void runCase(BENCHCASE *b,int rows,int cols);
+
+/* The maze read for a case with a thread count, and that count. */
+static GRID *Loaded = 0;
+static int Threads = 0;
+
+static BENCHCASE Cases[] =
+{
+    {"generate dfs",       0,            runDFS,        0},
+    {"generate backtrack", 0,            runBACKTRACK,  0},
+    {"generate stepped",   0,            runSTEPPED,    0},
+    {"generate kruskal",   0,            runKRUSKAL,    0},
+    {"generate wilson",    0,            runWILSON,     0},
+    {"generate hybrid",    0,            runHYBRID,     0},
+    {"generate nmaze",     0,            runNMAZE,      0},
+    {"generate square",    0,            runSQUARE,     0},
+    {"generate torus",     0,            runTORUS,      0},
+    {"generate hex",       0,            runHEX,        0},
+    {"weighted bfs",       makeWEIGHTED, runBFS,        0},
+    {"weighted dijkstra",  makeWEIGHTED, runDIJKSTRA,   0},
+    {"braided bfs",        makeBRAIDED,  runBFS,        0},
+    {"braided astar",      makeBRAIDED,  runASTAR,      0},
+    {"braided jps",        makeBRAIDED,  runJPS,        0},
+    {"braided stats",      makeBRAIDED,  runSTATS,      0},
+    {"braided route",      makeBRAIDED,  runROUTE,      0},
+    {"braided pbfs 1",     makeBRAIDED,  runPBFS,       1},
+    {"braided pbfs 2",     makeBRAIDED,  runPBFS,       2},
+    {"braided pbfs 4",     makeBRAIDED,  runPBFS,       4},
+    {"braided pbfs 8",     makeBRAIDED,  runPBFS,       8},
+    {"braided pbfs 16",    makeBRAIDED,  runPBFS,      16},
+    {"braided pbfs 32",    makeBRAIDED,  runPBFS,      32},
+    {"bitboard 16x16",     0,            runBBOARD16,   0},
+    {"bitboard 64x64",     0,            runBBOARD64,   0},
+    {"packed solve",       makePACKED,   runPACKED,     0},
+    {"archive pack",       makeKRUSKAL,  runARCHIVE,    0},
+    {"archive read",       makeARCHIVE,  runUNARCHIVE,  0},
+    {"image pbm",          makeKRUSKAL,  runIMAGE,      0},
+    {"image svg",          makeKRUSKAL,  runSVG,        0},
+};
+
+int
+main(int argc,char **argv)
+    {
+    int rows = 1000;
+    int cols = 1000;
+    if (argc == 3)
+        {
+        rows = atoi(argv[1]);
+        cols = atoi(argv[2]);
+        }
+
+    printf("%-24s %12s %14s %12s\n","case","seconds","cells/sec","peak KB");
+    for (size_t i = 0; i < sizeof(Cases) / sizeof(Cases[0]); ++i)
+        runCase(&Cases[i],rows,cols);
+    printRatio(rows,cols);
+
+    return 0;
+    }
+
+static void runDFS(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createMAZE(rows,cols,1,out);
+}
+
+static void runBACKTRACK(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createBACKTRACK(rows,cols,1,out);
+}
+
+/* The backtracker run a thousand moves at a time, as a program drawing
+   it frame by frame would. */
+static void runSTEPPED(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    BACKTRACK *b = newBACKTRACK(rows,cols,1);
+    while (!isBACKTRACKdone(b)) {stepBACKTRACK(b,1000);}
+    writeGRID(getBACKTRACKgrid(b),out);
+    freeGRID(getBACKTRACKgrid(b));
+    freeBACKTRACK(b);
+}
+
+static void runKRUSKAL(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createKRUSKAL(rows,cols,1,out);
+}
+
+static void runWILSON(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createWILSON(rows,cols,1,out);
+}
+
+static void runHYBRID(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createHYBRID(rows,cols,1,out);
+}
+
+/* The n-dimensional engine on a single level, for comparison with the
+   two dimensional generators. */
+static void runNMAZE(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    int extents[2] = {rows,cols};
+    createNMAZE(2,extents,1,out);
+}
+
+static void runSQUARE(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createTGRID(TGRID_SQUARE,rows,cols,1,out);
+}
+
+static void runTORUS(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createTGRID(TGRID_TORUS,rows,cols,1,out);
+}
+
+static void runHEX(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    createTGRID(TGRID_HEX,rows,cols,1,out);
+}
+
+static void runBFS(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    solveMAZE(in,out);
+}
+
+static void runDIJKSTRA(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    solveWEIGHTED(in,out);
+}
+
+static void runASTAR(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    solveASTAR(in,out);
+}
+
+static void runJPS(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    solveJPS(in,out);
+}
+
+static void runSTATS(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    statsMAZE(in,out);
+}
+
+/* Finds the distance to every cell of the maze read before the clock. */
+static void runPBFS(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in; (void)out;
+    unsigned int *dist = malloc(sizeof(unsigned int) * rows * cols);
+    pbfsGRID(Loaded,getGRIDstart(Loaded),Threads,dist);
+    free(dist);
+}
+
+static void runBBOARD16(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    runBBOARD(16,(long)rows * cols,out);
+}
+
+static void runBBOARD64(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)in;
+    runBBOARD(64,(long)rows * cols,out);
+}
+
+/* Generates and solves size x size mazes until as many cells have been
+   made as the other cases make. */
+static void runBBOARD(int size,long cells,FILE *out)
+{
+    BBOARD b;
+    uint64_t path[BBOARD_MAX];
+    long steps = 0;
+    for (long i = 0; i < cells / (size * size); ++i)
+    {
+        generateBBOARD(&b,size,size,i + 1);
+        steps += pathBBOARD(&b,path);
+    }
+    fprintf(out,"%ld\n",steps);
+}
+
+static void runPACKED(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    solveSMAZE(in,out);
+}
+
+/* A Kruskal maze packed two bits to a cell. */
+static void makePACKED(int rows,int cols,FILE *in)
+{
+    GRID *g = generateKRUSKAL(rows,cols,1);
+    SMAZE *s = encodeSMAZE(g);
+    writeSMAZE(s,in);
+    freeSMAZE(s);
+    freeGRID(g);
+}
+
+static void runROUTE(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    solveROUTE(in,out,0);
+}
+
+static void runIMAGE(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    rasterMAZE(in,0,out,2,0);
+}
+
+static void runSVG(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    svgMAZE(in,out,2,1);
+}
+
+static void runARCHIVE(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols;
+    packARCHIVE(in,out);
+}
+
+static void runUNARCHIVE(int rows,int cols,FILE *in,FILE *out)
+{
+    (void)rows; (void)cols; (void)out;
+    freeGRID(readGRID(in));
+}
+
+static void makeKRUSKAL(int rows,int cols,FILE *in)
+{
+    createKRUSKAL(rows,cols,1,in);
+}
+
+/* A Kruskal maze as a compressed archive. */
+static void makeARCHIVE(int rows,int cols,FILE *in)
+{
+    GRID *g = generateKRUSKAL(rows,cols,1);
+    writeARCHIVE(g,ARCHIVE_BLOCK_ROWS,in);
+    freeGRID(g);
+}
+
+static void printRatio(int rows,int cols)
+{
+    FILE *text = tmpfile();
+    GRID *g = generateKRUSKAL(rows,cols,1);
+    writeGRID(g,text);
+    long textBytes = ftell(text);
+    long archiveBytes = writeARCHIVE(g,ARCHIVE_BLOCK_ROWS,text);
+    printf("\narchive size: %ld bytes as text, %ld bytes archived, %.1f to 1,"
+        " %.2f bits per cell\n",textBytes,archiveBytes,
+        (double)textBytes / archiveBytes,8.0 * archiveBytes / rows / cols);
+    freeGRID(g);
+    fclose(text);
+}
+
+/* A Kruskal maze with costs from 1 to 9. */
+static void makeWEIGHTED(int rows,int cols,FILE *in)
+{
+    createKRUSKAL(rows,cols,1,in);
+    writeCOSTS(rows,cols,9,1,in);
+}
+
+/* A Kruskal maze with half its dead ends removed and one room for every
+   200 cells. */
+static void makeBRAIDED(int rows,int cols,FILE *in)
+{
+    GRID *g = generateKRUSKAL(rows,cols,1);
+    carveGRIDrooms(g,(long)rows * cols / 200,1);
+    braidGRID(g,50,1);
+    writeGRID(g,in);
+    freeGRID(g);
+}
+
+static void runCase(BENCHCASE *b,int rows,int cols)
+{
+    FILE *in = 0;
+    pid_t pid;
+
+    fflush(stdout);
+    if (b->setup)
+    {
+        in = tmpfile();
+        pid = fork();
+        if (pid == 0)
+        {
+            b->setup(rows,cols,in);
+            exit(0);
+        }
+        waitpid(pid,0,0);
+    }
+
+    pid = fork();
+    if (pid == 0)
+    {
+        FILE *out = fopen("/dev/null","w");
+        struct timespec start, end;
+        struct rusage usage;
+
+        if (in) {rewind(in);}
+        if (b->threads)
+        {
+            Loaded = readGRID(in);
+            Threads = b->threads;
+        }
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        b->run(rows,cols,in,out);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        fclose(out);
+        if (Loaded) {freeGRID(Loaded);}
+        getrusage(RUSAGE_SELF,&usage);
+
+        double secs = (end.tv_sec - start.tv_sec)
+            + (end.tv_nsec - start.tv_nsec) / 1e9;
+        printf("%-24s %12.3f %14.0f %12ld\n",b->name,secs,
+            (double)rows * cols / secs,usage.ru_maxrss);
+        exit(0);
+    }
+    waitpid(pid,0,0);
+    if (in) {fclose(in);}
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+ * This module turns perfect mazes into braided mazes, which have loops    *
+ * and open rooms. Both passes only ever remove walls, so a maze that was  *
+ * connected stays connected and its entrance and exit are untouched.      *
+ *                                                                         *
+ * braidGRID removes a given percentage of the dead ends by opening one    *
+ * more wall of each, preferring a wall shared with another dead end so    *
+ * that both are removed at once. carveGRIDrooms opens every wall inside   *
+ * randomly placed rectangles of 2 to 6 cells on a side.                   *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "braid.h"
+#include "grid.h"
+#include <stdlib.h>
+#include <assert.h>
+
+// Necissary for random() and srandom() to work.
+long int random(void);
+void srandom(unsigned int seed);
+
+static int openSides(GRID *g,int row,int col);
+static int isInside(GRID *g,int row,int col,int wall);
+
+static int RowStep[4] = {-1,0,0,1};
+static int ColStep[4] = {0,-1,1,0};
+
+/* Returns the number of dead ends removed. */
+long braidGRID(GRID *g,int percent,int randSeed)
+{
+    assert(percent >= 0 && percent <= 100);
+    srandom(randSeed);
+    long removed = 0;
+
+    for (int i = 0; i < getGRIDrows(g); ++i)
+        for (int j = 0; j < getGRIDcols(g); ++j)
+        {
+            if (openSides(g,i,j) != 1) {continue;}
+            if (random() % 100 >= percent) {continue;}
+
+            /* Pick a closed wall at random, but take one that leads to
+               another dead end if there is one. */
+            int choices[4];
+            int count = 0;
+            int best = -1;
+            for (int wall = 0; wall < 4; ++wall)
+            {
+                if (!isInside(g,i,j,wall) || !getGRIDwall(g,i,j,wall))
+                    continue;
+                choices[count++] = wall;
+                if (openSides(g,i+RowStep[wall],j+ColStep[wall]) == 1)
+                    best = wall;
+            }
+            if (count == 0) {continue;}
+            if (best == -1) {best = choices[random() % count];}
+
+            removeGRIDwall(g,i,j,best);
+            ++removed;
+        }
+
+    return removed;
+}
+
+void carveGRIDrooms(GRID *g,int count,int randSeed)
+{
+    srandom(randSeed);
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+
+    for (int room = 0; room < count; ++room)
+    {
+        int height = 2 + random() % 5;
+        int width = 2 + random() % 5;
+        if (height > rows) {height = rows;}
+        if (width > cols) {width = cols;}
+        int top = random() % (rows - height + 1);
+        int left = random() % (cols - width + 1);
+
+        for (int i = top; i < top + height; ++i)
+            for (int j = left; j < left + width; ++j)
+            {
+                if (j < left + width - 1) {removeGRIDwall(g,i,j,2);}
+                if (i < top + height - 1) {removeGRIDwall(g,i,j,3);}
+            }
+    }
+}
+
+/* Returns the number of open walls between a cell and its neighbors. The
+   entrance and exit are not counted, since they lead out of the maze. */
+static int openSides(GRID *g,int row,int col)
+{
+    int count = 0;
+    for (int wall = 0; wall < 4; ++wall)
+        if (isInside(g,row,col,wall) && !getGRIDwall(g,row,col,wall))
+            ++count;
+    return count;
+}
+
+/* Returns 1 if the given wall of a cell is shared with another cell. */
+static int isInside(GRID *g,int row,int col,int wall)
+{
+    int r = row + RowStep[wall];
+    int c = col + ColStep[wall];
+    return r >= 0 && r < getGRIDrows(g) && c >= 0 && c < getGRIDcols(g);
+}
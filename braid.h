@@ -0,0 +1,9 @@
+#ifndef __BRAID_INCLUDED__
+#define __BRAID_INCLUDED__
+
+#include "grid.h"
+
+extern long braidGRID(GRID *g,int percent,int randSeed);
+extern void carveGRIDrooms(GRID *g,int count,int randSeed);
+
+#endif
@@ -0,0 +1,290 @@
+/***************************************************************************
+ * This module keeps the output of earlier commands in a directory so that *
+ * asking for the same maze or solution again is a copy instead of a fresh *
+ * computation. Each entry is named by a 64 bit FNV-1a hash of everything  *
+ * that decides the output: the command, its parameters, CACHE_VERSION,    *
+ * and, for solutions, the bytes of the maze being solved. An entry is a   *
+ * small binary header followed by the output exactly as it was written:   *
+ *                                                                         *
+ *   "MZCA" version length key              (32, 32, 64, and 64 bits)      *
+ *   length bytes of output                                                *
+ *                                                                         *
+ * An entry is written to a temporary file and renamed into place, so      *
+ * other processes see either the whole entry or none of it. A hit is read *
+ * with mmap, checked against its header, and copied out, and its time of  *
+ * last use is updated. When an entry is added and the directory holds     *
+ * more than its limit, the entries used longest ago are removed. Removal  *
+ * holds an exclusive lock on the directory's lock file, so only one       *
+ * process evicts at a time; a process still reading a removed entry keeps *
+ * its mapping.                                                            *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include "cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/time.h>
+#include <assert.h>
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME  0x100000001b3ull
+#define HEADER_BYTES 24
+
+struct cache
+{
+    char *dir;
+    long maxBytes;
+};
+
+typedef struct entry
+{
+    char name[32];
+    time_t used;
+    long bytes;
+} ENTRY;
+
+static unsigned long long hashBytes(const unsigned char *p,size_t n,
+                                    unsigned long long h);
+static void entryPath(CACHE *c,unsigned long long key,char *path,size_t n);
+static int  copyOut(const unsigned char *p,size_t n,const char *outPath);
+static void evict(CACHE *c);
+static int  compareUsed(const void *a,const void *b);
+
+/* Creates the directory if it doesn't exist. Returns 0 if it can't be
+   used. */
+CACHE *newCACHE(const char *dir,long maxBytes)
+{
+    struct stat st;
+    if (mkdir(dir,0777) != 0 && (stat(dir,&st) != 0 || !S_ISDIR(st.st_mode)))
+        return 0;
+
+    CACHE *c = malloc(sizeof(CACHE));
+    assert(c != 0);
+    c->dir = malloc(strlen(dir) + 1);
+    assert(c->dir != 0);
+    strcpy(c->dir,dir);
+    c->maxBytes = maxBytes;
+    return c;
+}
+
+/* Hashes text along with the cache version. Pass 0 as seed to start a
+   new key, or an earlier key to extend it. */
+unsigned long long keyCACHE(const char *text,unsigned long long seed)
+{
+    unsigned long long h = seed ? seed : FNV_OFFSET;
+    uint32_t version = CACHE_VERSION;
+    h = hashBytes((const unsigned char *)&version,sizeof(version),h);
+    return hashBytes((const unsigned char *)text,strlen(text),h);
+}
+
+/* Extends a key with the contents of a file, or returns 0 if it can't be
+   read. */
+unsigned long long keyCACHEfile(const char *path,unsigned long long seed)
+{
+    int fd = open(path,O_RDONLY);
+    if (fd < 0) {return 0;}
+    struct stat st;
+    unsigned long long h = seed ? seed : FNV_OFFSET;
+    if (fstat(fd,&st) == 0 && st.st_size > 0)
+    {
+        void *p = mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        if (p == MAP_FAILED) {h = 0;}
+        else
+        {
+            h = hashBytes(p,st.st_size,h);
+            munmap(p,st.st_size);
+        }
+    }
+    close(fd);
+    return h;
+}
+
+/* Copies the entry for key to outPath and returns 1, or returns 0 if there
+   is no good entry. */
+int fetchCACHE(CACHE *c,unsigned long long key,const char *outPath)
+{
+    char path[4096];
+    entryPath(c,key,path,sizeof(path));
+    int fd = open(path,O_RDONLY);
+    if (fd < 0) {return 0;}
+
+    int hit = 0;
+    struct stat st;
+    if (fstat(fd,&st) == 0 && st.st_size >= HEADER_BYTES)
+    {
+        unsigned char *p = mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+        if (p != MAP_FAILED)
+        {
+            uint32_t version;
+            uint64_t length, stored;
+            memcpy(&version,p + 4,4);
+            memcpy(&length,p + 8,8);
+            memcpy(&stored,p + 16,8);
+            if (memcmp(p,"MZCA",4) == 0 && version == CACHE_VERSION &&
+                stored == key && length == (uint64_t)st.st_size - HEADER_BYTES)
+                hit = copyOut(p + HEADER_BYTES,length,outPath);
+            munmap(p,st.st_size);
+        }
+    }
+    close(fd);
+
+    // Mark the entry as just used.
+    if (hit) {utimes(path,0);}
+    return hit;
+}
+
+/* Adds the contents of the file at path as the entry for key. Failures
+   are ignored, since the cache is only an optimization. */
+void storeCACHE(CACHE *c,unsigned long long key,const char *path)
+{
+    int in = open(path,O_RDONLY);
+    if (in < 0) {return;}
+    struct stat st;
+    if (fstat(in,&st) != 0)
+    {
+        close(in);
+        return;
+    }
+
+    char final[4096], temp[4096];
+    entryPath(c,key,final,sizeof(final));
+    snprintf(temp,sizeof(temp),"%s/.tmp.%ld.%016llx",c->dir,(long)getpid(),
+        key);
+    int out = open(temp,O_WRONLY | O_CREAT | O_TRUNC,0666);
+    if (out < 0)
+    {
+        close(in);
+        return;
+    }
+
+    unsigned char header[HEADER_BYTES];
+    uint32_t version = CACHE_VERSION;
+    uint64_t length = st.st_size, stored = key;
+    memcpy(header,"MZCA",4);
+    memcpy(header + 4,&version,4);
+    memcpy(header + 8,&length,8);
+    memcpy(header + 16,&stored,8);
+    int ok = write(out,header,HEADER_BYTES) == HEADER_BYTES;
+
+    char buffer[1 << 16];
+    ssize_t got;
+    while (ok && (got = read(in,buffer,sizeof(buffer))) > 0)
+        ok = write(out,buffer,got) == got;
+    close(in);
+    if (close(out) != 0) {ok = 0;}
+
+    if (!ok || rename(temp,final) != 0)
+    {
+        unlink(temp);
+        return;
+    }
+    evict(c);
+}
+
+void freeCACHE(CACHE *c)
+{
+    free(c->dir);
+    free(c);
+}
+
+static unsigned long long hashBytes(const unsigned char *p,size_t n,
+                                    unsigned long long h)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+static void entryPath(CACHE *c,unsigned long long key,char *path,size_t n)
+{
+    snprintf(path,n,"%s/%016llx.mzc",c->dir,key);
+}
+
+static int copyOut(const unsigned char *p,size_t n,const char *outPath)
+{
+    FILE *fp = fopen(outPath,"wb");
+    if (fp == 0) {return 0;}
+    int ok = fwrite(p,1,n,fp) == n;
+    if (fclose(fp) != 0) {ok = 0;}
+    return ok;
+}
+
+/* Removes the entries used longest ago until the directory is within its
+   limit. */
+static void evict(CACHE *c)
+{
+    char path[4096];
+    snprintf(path,sizeof(path),"%s/lock",c->dir);
+    int lock = open(path,O_RDWR | O_CREAT,0666);
+    if (lock < 0) {return;}
+    if (flock(lock,LOCK_EX | LOCK_NB) != 0)
+    {
+        // Another process is already evicting.
+        close(lock);
+        return;
+    }
+
+    DIR *d = opendir(c->dir);
+    if (d == 0)
+    {
+        close(lock);
+        return;
+    }
+    int count = 0, capacity = 64;
+    long total = 0;
+    ENTRY *entries = malloc(sizeof(ENTRY) * capacity);
+    assert(entries != 0);
+    struct dirent *de;
+    while ((de = readdir(d)) != 0)
+    {
+        size_t len = strlen(de->d_name);
+        if (len != 20 || strcmp(de->d_name + 16,".mzc") != 0) {continue;}
+        struct stat st;
+        snprintf(path,sizeof(path),"%s/%s",c->dir,de->d_name);
+        if (stat(path,&st) != 0) {continue;}
+        if (count == capacity)
+        {
+            capacity *= 2;
+            entries = realloc(entries,sizeof(ENTRY) * capacity);
+            assert(entries != 0);
+        }
+        strcpy(entries[count].name,de->d_name);
+        entries[count].used = st.st_mtime;
+        entries[count].bytes = st.st_size;
+        total += st.st_size;
+        ++count;
+    }
+    closedir(d);
+
+    qsort(entries,count,sizeof(ENTRY),compareUsed);
+    for (int i = 0; i < count && total > c->maxBytes; ++i)
+    {
+        snprintf(path,sizeof(path),"%s/%s",c->dir,entries[i].name);
+        if (unlink(path) == 0) {total -= entries[i].bytes;}
+    }
+
+    free(entries);
+    flock(lock,LOCK_UN);
+    close(lock);
+}
+
+static int compareUsed(const void *a,const void *b)
+{
+    time_t x = ((const ENTRY *)a)->used, y = ((const ENTRY *)b)->used;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,20 @@
+#ifndef __CACHE_INCLUDED__
+#define __CACHE_INCLUDED__
+
+#include <stdio.h>
+
+/* Bump whenever the output of a cached command changes, so that entries
+   written by older versions are never served. */
+#define CACHE_VERSION 2
+
+typedef struct cache CACHE;
+
+extern CACHE *newCACHE(const char *dir,long maxBytes);
+extern unsigned long long keyCACHE(const char *text,unsigned long long seed);
+extern unsigned long long keyCACHEfile(const char *path,
+                              unsigned long long seed);
+extern int  fetchCACHE(CACHE *c,unsigned long long key,const char *outPath);
+extern void storeCACHE(CACHE *c,unsigned long long key,const char *path);
+extern void freeCACHE(CACHE *c);
+
+#endif
@@ -0,0 +1,399 @@
+/***************************************************************************
+ * This module finds the cells that differ between two mazes of the same   *
+ * size and ships only those. A delta holds, for each changed cell, its    *
+ * new walls, value, or cost, along with the entrance and exit of the new  *
+ * maze. Its file format is:                                               *
+ *                                                                         *
+ *   "MZDF" version rows cols           (unsigned 32-bit)                  *
+ *   start goal                         (unsigned 64-bit)                  *
+ *   for each changed cell, in order:                                      *
+ *     distance from the last changed cell (a varint, the first counted    *
+ *     from -1), a byte of flags, and then whichever of the walls (one     *
+ *     byte), value (a zigzag varint), and cost (one byte) changed         *
+ *   a 0 varint                                                            *
+ *                                                                         *
+ * Bit 4 of the flags is set when the walls changed, bit 5 the value, and  *
+ * bit 6 the cost. A varint is seven bits to a byte, low bits first, with  *
+ * the high bit set on every byte but the last. Both cells on either side  *
+ * of a changed wall are recorded, so each cell's walls can be set alone.  *
+ *                                                                         *
+ * A binary grid ("MZGD") is patched in place through mmap, writing only   *
+ * the changed cells, so the cost depends on the size of the delta and not *
+ * of the maze. Text mazes and archives are read, patched, and rewritten; *
+ * since an archive keeps only walls, a delta that changes values or costs *
+ * is refused for one rather than half applied.                            *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include "delta.h"
+#include "grid.h"
+#include "arch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <assert.h>
+
+#define DELTA_VERSION 1
+#define WALLS_CHANGED 0x10
+#define VALUE_CHANGED 0x20
+#define COST_CHANGED 0x40
+
+struct delta
+{
+    int rows;
+    int cols;
+    long start;
+    long goal;
+    long size;
+    long capacity;
+    long *cells;
+    unsigned char *flags;
+    int *values;
+    unsigned char *costs;
+};
+
+static DELTA *newDELTA(int rows,int cols);
+static void  addChange(DELTA *d,long cell,int flags,int value,int cost);
+static void  putVarint(uint64_t n,FILE *fp);
+static int   getVarint(uint64_t *n,FILE *fp);
+static long  rewriteMAZE(DELTA *d,const char *path);
+
+/* Returns 0 if the mazes aren't the same size. */
+DELTA *diffDELTA(GRID *from,GRID *to)
+{
+    int rows = getGRIDrows(to), cols = getGRIDcols(to);
+    if (getGRIDrows(from) != rows || getGRIDcols(from) != cols) {return 0;}
+    DELTA *d = newDELTA(rows,cols);
+    d->start = getGRIDstart(to);
+    d->goal = getGRIDgoal(to);
+
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+        {
+            int walls = getGRIDwalls(to,i,j);
+            int value = getGRIDval(to,i,j);
+            int cost = getGRIDcost(to,i,j);
+            int flags = walls;
+            if (walls != getGRIDwalls(from,i,j)) {flags |= WALLS_CHANGED;}
+            if (value != getGRIDval(from,i,j)) {flags |= VALUE_CHANGED;}
+            if (cost != getGRIDcost(from,i,j)) {flags |= COST_CHANGED;}
+            if (flags & 0x70)
+                addChange(d,(long)i * cols + j,flags,value,cost);
+        }
+    return d;
+}
+
+/* Returns the number of changed cells. */
+long sizeDELTA(DELTA *d) {return d->size;}
+
+void writeDELTA(DELTA *d,FILE *fp)
+{
+    uint32_t header[3] = {DELTA_VERSION,d->rows,d->cols};
+    uint64_t ends[2] = {d->start,d->goal};
+    fwrite("MZDF",1,4,fp);
+    fwrite(header,sizeof(uint32_t),3,fp);
+    fwrite(ends,sizeof(uint64_t),2,fp);
+
+    long last = -1;
+    for (long k = 0; k < d->size; ++k)
+    {
+        putVarint(d->cells[k] - last,fp);
+        last = d->cells[k];
+        putc(d->flags[k] & 0x70,fp);
+        if (d->flags[k] & WALLS_CHANGED) {putc(d->flags[k] & 0xF,fp);}
+        if (d->flags[k] & VALUE_CHANGED)
+        {
+            int64_t v = d->values[k];
+            putVarint((uint64_t)v << 1 ^ (uint64_t)(v >> 63),fp);
+        }
+        if (d->flags[k] & COST_CHANGED) {putc(d->costs[k],fp);}
+    }
+    putVarint(0,fp);
+}
+
+/* Returns 0 if the file isn't a delta or is cut short. */
+DELTA *readDELTA(FILE *fp)
+{
+    char magic[4];
+    uint32_t header[3];
+    uint64_t ends[2];
+    if (fread(magic,1,4,fp) != 4 || memcmp(magic,"MZDF",4) != 0) {return 0;}
+    if (fread(header,sizeof(uint32_t),3,fp) != 3 ||
+        fread(ends,sizeof(uint64_t),2,fp) != 2) {return 0;}
+    if (header[0] != DELTA_VERSION || header[1] == 0 || header[2] == 0 ||
+        header[1] > INT_MAX || header[2] > INT_MAX ||
+        ends[0] > LONG_MAX || ends[1] > LONG_MAX) {return 0;}
+
+    DELTA *d = newDELTA(header[1],header[2]);
+    long cells = (long)d->rows * d->cols;
+    d->start = ends[0];
+    d->goal = ends[1];
+    int ok = d->start < cells && d->goal < cells;
+
+    uint64_t gap = 0, value = 0;
+    long cell = -1;
+    while (ok && (ok = getVarint(&gap,fp)) && gap != 0)
+    {
+        int flags = getc(fp), walls = 0, cost = 1;
+        ok = flags != EOF && (flags & ~0x70) == 0 && flags != 0
+            && gap < (uint64_t)(cells - cell);
+        if (!ok) {break;}
+        cell += gap;
+        if (ok && flags & WALLS_CHANGED)
+        {
+            walls = getc(fp);
+            ok = walls != EOF && (walls & ~0xF) == 0;
+        }
+        if (ok && flags & VALUE_CHANGED) {ok = getVarint(&value,fp);}
+        if (ok && flags & COST_CHANGED)
+        {
+            cost = getc(fp);
+            ok = cost != EOF && cost > 0;
+        }
+        if (ok)
+            addChange(d,cell,flags | walls,
+                (int)((value >> 1) ^ (~(value & 1) + 1)),cost);
+    }
+    if (!ok)
+    {
+        freeDELTA(d);
+        return 0;
+    }
+    return d;
+}
+
+/* Applies the delta to a grid in memory. Returns 0 if they aren't the same
+   size. */
+int applyDELTA(DELTA *d,GRID *g)
+{
+    if (getGRIDrows(g) != d->rows || getGRIDcols(g) != d->cols) {return 0;}
+    for (long k = 0; k < d->size; ++k)
+    {
+        int row = d->cells[k] / d->cols, col = d->cells[k] % d->cols;
+        int flags = d->flags[k];
+        if (flags & WALLS_CHANGED)
+        {
+            int walls = getGRIDwalls(g,row,col);
+            for (int wall = 0; wall < 4; ++wall)
+            {
+                int want = flags >> wall & 1;
+                if (want == (walls >> wall & 1)) {continue;}
+                if (want) {addGRIDwall(g,row,col,wall);}
+                else {removeGRIDwall(g,row,col,wall);}
+            }
+        }
+        if (flags & VALUE_CHANGED) {setGRIDval(g,row,col,d->values[k]);}
+        if (flags & COST_CHANGED) {setGRIDcost(g,row,col,d->costs[k]);}
+    }
+    placeGRIDends(g,d->start,d->goal);
+    return 1;
+}
+
+/* Patches the binary grid in the file in place, touching only the changed
+   cells. Returns the number of cells changed, -1 if the grid isn't the
+   size of the delta, or -2 if the file isn't a binary grid or the delta
+   gives costs to a grid without them, so that it must be rewritten. */
+long patchDELTA(DELTA *d,const char *path)
+{
+    int fd = open(path,O_RDWR);
+    if (fd < 0) {return -2;}
+    struct stat st;
+    if (fstat(fd,&st) != 0 || st.st_size < GRID_HEADER_BYTES)
+    {
+        close(fd);
+        return -2;
+    }
+    unsigned char *map = mmap(0,st.st_size,PROT_READ | PROT_WRITE,
+        MAP_SHARED,fd,0);
+    close(fd);
+    if (map == MAP_FAILED) {return -2;}
+
+    uint32_t header[3];
+    memcpy(header,map + 4,sizeof(header));
+    long cells = (long)header[0] * header[1];
+    int hasCosts = header[2] & 1;
+    long result = d->size;
+    if (memcmp(map,"MZGD",4) != 0 ||
+        st.st_size < GRID_HEADER_BYTES + cells * (5 + hasCosts))
+        result = -2;
+    else if ((int)header[0] != d->rows || (int)header[1] != d->cols)
+        result = -1;
+    for (long k = 0; result >= 0 && !hasCosts && k < d->size; ++k)
+        if (d->flags[k] & COST_CHANGED) {result = -2;}
+
+    if (result >= 0)
+    {
+        unsigned char *walls = map + GRID_HEADER_BYTES;
+        unsigned char *values = walls + cells;
+        unsigned char *costs = values + cells * sizeof(int32_t);
+        for (long k = 0; k < d->size; ++k)
+        {
+            long cell = d->cells[k];
+            int flags = d->flags[k];
+            if (flags & WALLS_CHANGED) {walls[cell] = flags & 0xF;}
+            if (flags & VALUE_CHANGED)
+            {
+                int32_t value = d->values[k];
+                memcpy(values + cell * sizeof(int32_t),&value,sizeof(value));
+            }
+            if (flags & COST_CHANGED) {costs[cell] = d->costs[k];}
+        }
+        uint64_t ends[2] = {d->start,d->goal};
+        memcpy(map + 4 + sizeof(header),ends,sizeof(ends));
+    }
+    munmap(map,st.st_size);
+    return result;
+}
+
+void freeDELTA(DELTA *d)
+{
+    free(d->cells);
+    free(d->flags);
+    free(d->values);
+    free(d->costs);
+    free(d);
+}
+
+/* Writes the delta that turns the first maze into the second. Returns the
+   number of changed cells, or -1 if either isn't a maze or their sizes
+   differ. */
+long diffMAZE(FILE *fromFile,FILE *toFile,FILE *deltaFile)
+{
+    GRID *from = readGRID(fromFile);
+    GRID *to = readGRID(toFile);
+    DELTA *d = from && to ? diffDELTA(from,to) : 0;
+    long changed = -1;
+    if (d)
+    {
+        writeDELTA(d,deltaFile);
+        changed = sizeDELTA(d);
+        freeDELTA(d);
+    }
+    if (from) {freeGRID(from);}
+    if (to) {freeGRID(to);}
+    return changed;
+}
+
+/* Applies the delta to the maze in the file. Returns the number of changed
+   cells, -1 if the maze and delta don't match, -2 if the delta can't be
+   read, or -3 if the maze is an archive and the delta changes values or
+   costs, which an archive doesn't keep. */
+long patchMAZE(const char *path,FILE *deltaFile)
+{
+    DELTA *d = readDELTA(deltaFile);
+    if (d == 0) {return -2;}
+    long changed = patchDELTA(d,path);
+    if (changed == -2) {changed = rewriteMAZE(d,path);}
+    freeDELTA(d);
+    return changed;
+}
+
+/* Patches a maze that can't be changed in place by reading it whole and
+   writing it back out in the format it was in. An archive is left alone
+   if the delta would change a value or cost, since writing it back out
+   would lose them. */
+static long rewriteMAZE(DELTA *d,const char *path)
+{
+    FILE *fp = fopen(path,"rb");
+    if (fp == 0) {return -1;}
+    char magic[4] = {0};
+    size_t got = fread(magic,1,4,fp);
+    int archive = got == 4 && memcmp(magic,"MZAR",4) == 0;
+    for (long k = 0; archive && k < d->size; ++k)
+        if (d->flags[k] & (VALUE_CHANGED | COST_CHANGED))
+        {
+            fclose(fp);
+            return -3;
+        }
+    rewind(fp);
+    GRID *g = readGRID(fp);
+    fclose(fp);
+    if (g == 0 || !applyDELTA(d,g))
+    {
+        if (g) {freeGRID(g);}
+        return -1;
+    }
+
+    fp = fopen(path,"wb");
+    if (fp == 0)
+    {
+        freeGRID(g);
+        return -1;
+    }
+    if (archive)
+        writeARCHIVE(g,ARCHIVE_BLOCK_ROWS,fp);
+    else if (got == 4 && memcmp(magic,"MZGD",4) == 0) {writeGRIDbinary(g,fp);}
+    else {writeGRID(g,fp);}
+    fclose(fp);
+    freeGRID(g);
+    return d->size;
+}
+
+static DELTA *newDELTA(int rows,int cols)
+{
+    DELTA *d = malloc(sizeof(DELTA));
+    assert(d != 0);
+    d->rows = rows;
+    d->cols = cols;
+    d->start = 0;
+    d->goal = (long)rows * cols - 1;
+    d->size = 0;
+    d->capacity = 0;
+    d->cells = 0;
+    d->flags = 0;
+    d->values = 0;
+    d->costs = 0;
+    return d;
+}
+
+static void addChange(DELTA *d,long cell,int flags,int value,int cost)
+{
+    if (d->size == d->capacity)
+    {
+        d->capacity = d->capacity ? d->capacity * 2 : 64;
+        d->cells = realloc(d->cells,sizeof(long) * d->capacity);
+        d->flags = realloc(d->flags,d->capacity);
+        d->values = realloc(d->values,sizeof(int) * d->capacity);
+        d->costs = realloc(d->costs,d->capacity);
+        assert(d->cells != 0 && d->flags != 0 && d->values != 0
+            && d->costs != 0);
+    }
+    d->cells[d->size] = cell;
+    d->flags[d->size] = flags;
+    d->values[d->size] = value;
+    d->costs[d->size] = cost;
+    ++d->size;
+}
+
+static void putVarint(uint64_t n,FILE *fp)
+{
+    while (n >= 0x80)
+    {
+        putc((n & 0x7F) | 0x80,fp);
+        n >>= 7;
+    }
+    putc(n,fp);
+}
+
+/* Returns 0 if the file ends in the middle of the varint. */
+static int getVarint(uint64_t *n,FILE *fp)
+{
+    *n = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = getc(fp);
+        if (byte == EOF) {return 0;}
+        *n |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {return 1;}
+    }
+    return 0;
+}
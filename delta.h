@@ -0,0 +1,20 @@
+#ifndef __DELTA_INCLUDED__
+#define __DELTA_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+typedef struct delta DELTA;
+
+extern DELTA *diffDELTA(GRID *from,GRID *to);
+extern long   sizeDELTA(DELTA *d);
+extern void   writeDELTA(DELTA *d,FILE *fp);
+extern DELTA *readDELTA(FILE *fp);
+extern int    applyDELTA(DELTA *d,GRID *g);
+extern long   patchDELTA(DELTA *d,const char *path);
+extern void   freeDELTA(DELTA *d);
+
+extern long diffMAZE(FILE *fromFile,FILE *toFile,FILE *deltaFile);
+extern long patchMAZE(const char *path,FILE *deltaFile);
+
+#endif
@@ -0,0 +1,185 @@
+/***************************************************************************
+ * This module solves weighted mazes, where moving into a cell costs that  *
+ * cell's cost instead of one step, using Dijkstra's algorithm with Dial's *
+ * bucket queue in place of a heap. Costs are small integers no larger     *
+ * than C, so every cell waiting to be settled has a distance within C of  *
+ * the closest one. The queue is therefore C+1 buckets used in a circle,   *
+ * each a doubly linked list threaded through two arrays indexed by cell,  *
+ * and the next closest cell is found by stepping to the next non-empty    *
+ * bucket. Each cell is inserted, moved, and removed in constant time, so  *
+ * solving stays linear in the size of the maze plus the largest distance. *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "dial.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+/* Cell states. */
+#define UNSEEN  0
+#define QUEUED  1
+#define SETTLED 2
+
+typedef struct buckets
+{
+    int count;        /* number of buckets, C+1 */
+    int *head;        /* first cell of each bucket, or -1 */
+    int *next;        /* links of each queued cell */
+    int *prev;
+} BUCKETS;
+
+static void insertBucket(BUCKETS *b,long *dist,int cell);
+static void removeBucket(BUCKETS *b,long *dist,int cell);
+
+/* Fills dist with the cost of the cheapest path from the entrance to each
+   cell settled before the exit, or -1 for the rest. Returns the distance
+   of the exit, or -1 if it cannot be reached. */
+long dialGRID(GRID *g,long *dist)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    assert((long)rows * cols <= INT_MAX);
+    int size = rows * cols;
+    int start = getGRIDstart(g);
+    int goal = getGRIDgoal(g);
+
+    int maxCost = 1;
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            if (getGRIDcost(g,i,j) > maxCost) {maxCost = getGRIDcost(g,i,j);}
+
+    BUCKETS b;
+    b.count = maxCost + 1;
+    b.head = malloc(sizeof(int) * b.count);
+    b.next = malloc(sizeof(int) * size);
+    b.prev = malloc(sizeof(int) * size);
+    unsigned char *state = calloc(size,sizeof(unsigned char));
+    assert(b.head != 0 && b.next != 0 && b.prev != 0 && state != 0);
+    for (int i = 0; i < b.count; ++i)
+        b.head[i] = -1;
+    for (int i = 0; i < size; ++i)
+        dist[i] = -1;
+
+    dist[start] = 0;
+    state[start] = QUEUED;
+    insertBucket(&b,dist,start);
+    long queued = 1;
+    long current = 0;
+
+    while (queued > 0)
+    {
+        while (b.head[current % b.count] == -1)
+            ++current;
+        int cell = b.head[current % b.count];
+        removeBucket(&b,dist,cell);
+        --queued;
+        state[cell] = SETTLED;
+        if (cell == goal) {break;}
+
+        int row = cell / cols;
+        int col = cell % cols;
+        int next[4] = {cell - cols,cell - 1,cell + 1,cell + cols};
+        int inside[4] = {row > 0,col > 0,col < cols - 1,row < rows - 1};
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (!inside[wall] || getGRIDwall(g,row,col,wall)) {continue;}
+            int n = next[wall];
+            if (state[n] == SETTLED) {continue;}
+
+            long d = dist[cell] + getGRIDcost(g,n / cols,n % cols);
+            if (state[n] == QUEUED)
+            {
+                if (d >= dist[n]) {continue;}
+                removeBucket(&b,dist,n);
+                --queued;
+            }
+            dist[n] = d;
+            state[n] = QUEUED;
+            insertBucket(&b,dist,n);
+            ++queued;
+        }
+    }
+
+    /* Cells still queued only have estimates. */
+    for (int i = 0; i < size; ++i)
+        if (state[i] != SETTLED) {dist[i] = -1;}
+
+    free(state);
+    free(b.prev);
+    free(b.next);
+    free(b.head);
+    return dist[goal];
+}
+
+/* Solves a weighted maze and writes it with the distance of each cell on
+   the cheapest path, mod 10, in the same format as the maze class. Every
+   other cell has a value of -1. Returns the cost of the path, or -1. */
+long solveWEIGHTED(FILE *readFile,FILE *writeFile)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return -1;}
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+
+    long *dist = malloc(sizeof(long) * rows * cols);
+    assert(dist != 0);
+    long cost = dialGRID(g,dist);
+
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            setGRIDval(g,i,j,-1);
+
+    /* Walk back from the goal through the neighbor the cost came from. */
+    if (cost >= 0)
+    {
+        int row = getGRIDgoal(g) / cols, col = getGRIDgoal(g) % cols;
+        while (1)
+        {
+            long d = dist[(long)row * cols + col];
+            setGRIDval(g,row,col,d % 10);
+            if (d == 0) {break;}
+
+            int step = d - getGRIDcost(g,row,col);
+            int dr[4] = {-1,0,0,1};
+            int dc[4] = {0,-1,1,0};
+            for (int wall = 0; wall < 4; ++wall)
+            {
+                int r = row + dr[wall], c = col + dc[wall];
+                if (r < 0 || r >= rows || c < 0 || c >= cols) {continue;}
+                if (getGRIDwall(g,row,col,wall)) {continue;}
+                if (dist[(long)r * cols + c] == step)
+                {
+                    row = r;
+                    col = c;
+                    break;
+                }
+            }
+        }
+    }
+
+    writeGRID(g,writeFile);
+    free(dist);
+    freeGRID(g);
+    return cost;
+}
+
+static void insertBucket(BUCKETS *b,long *dist,int cell)
+{
+    int i = dist[cell] % b->count;
+    b->prev[cell] = -1;
+    b->next[cell] = b->head[i];
+    if (b->head[i] != -1) {b->prev[b->head[i]] = cell;}
+    b->head[i] = cell;
+}
+
+static void removeBucket(BUCKETS *b,long *dist,int cell)
+{
+    int i = dist[cell] % b->count;
+    if (b->prev[cell] != -1) {b->next[b->prev[cell]] = b->next[cell];}
+    else {b->head[i] = b->next[cell];}
+    if (b->next[cell] != -1) {b->prev[b->next[cell]] = b->prev[cell];}
+}
@@ -0,0 +1,10 @@
+#ifndef __DIAL_INCLUDED__
+#define __DIAL_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+extern long dialGRID(GRID *g,long *dist);
+extern long solveWEIGHTED(FILE *readFile,FILE *writeFile);
+
+#endif
@@ -0,0 +1,370 @@
+/***************************************************************************
+ * This dmaze class keeps a maze solved while its walls are edited. It     *
+ * holds a grid and the breadth-first search distance of every cell from   *
+ * the start, and repairs the distances after each edit instead of         *
+ * searching the whole maze again.                                         *
+ *                                                                         *
+ * Removing a wall can only shorten distances, so the shorter distance is  *
+ * spread outward from the newly joined cell and stops wherever it does    *
+ * not improve anything. Adding a wall can only lengthen them. The cells   *
+ * affected are exactly those left with no neighbor one step closer to the *
+ * start; they are found level by level from the cut, and their distances  *
+ * are rebuilt from the unaffected cells around them. Either way the work  *
+ * done is proportional to the cells whose distances change.               *
+ *                                                                         *
+ * The path from the start to the goal is never stored, since it can be    *
+ * walked back from the goal along decreasing distances.                   *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "dmaze.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+struct dmaze
+{
+    GRID *grid;
+    int rows;
+    int cols;
+    /* Distance of each cell from the start, or -1 if unreachable. */
+    long *dist;
+    /* 1 while a cell is waiting for a new distance, 2 once it has one. */
+    unsigned char *affected;
+    /* Scratch lists that grow to the largest edit seen so far. */
+    long *work;
+    long workCap;
+    long *seeds;
+    long seedsCap;
+    long *queue;
+    long queueCap;
+};
+
+static int  openNeighbor(DMAZE *m,long cell,int wall,long *next);
+static void growList(long **list,long *cap,long need);
+static void searchAll(DMAZE *m);
+static long spreadFrom(DMAZE *m,long cell);
+static long repairFrom(DMAZE *m,long cell);
+static int  compareDist(const void *a,const void *b);
+
+/* Sort key for compareDist, which qsort cannot pass in. */
+static long *SortDist;
+
+DMAZE *newDMAZE(GRID *g)
+{
+    DMAZE *m = malloc(sizeof(DMAZE));
+    assert(m != 0);
+
+    m->grid = g;
+    m->rows = getGRIDrows(g);
+    m->cols = getGRIDcols(g);
+    long size = (long)m->rows * m->cols;
+    m->dist = malloc(sizeof(long) * size);
+    m->affected = calloc(size,sizeof(unsigned char));
+    assert(m->dist != 0 && m->affected != 0);
+    m->work = m->seeds = m->queue = 0;
+    m->workCap = m->seedsCap = m->queueCap = 0;
+
+    searchAll(m);
+    return m;
+}
+
+/* Closes a wall and returns the number of cells whose distance changed. */
+long addDMAZEwall(DMAZE *m,int row,int col,int wall)
+{
+    if (getGRIDwall(m->grid,row,col,wall)) {return 0;}
+
+    long u = (long)row * m->cols + col;
+    long v;
+    int inside = openNeighbor(m,u,wall,&v);
+    addGRIDwall(m->grid,row,col,wall);
+    if (!inside || m->dist[u] == m->dist[v]) {return 0;}
+
+    /* Only the farther cell can lose its way back to the start. */
+    return repairFrom(m,m->dist[u] > m->dist[v] ? u : v);
+}
+
+/* Opens a wall and returns the number of cells whose distance changed. */
+long removeDMAZEwall(DMAZE *m,int row,int col,int wall)
+{
+    if (!getGRIDwall(m->grid,row,col,wall)) {return 0;}
+
+    removeGRIDwall(m->grid,row,col,wall);
+    long u = (long)row * m->cols + col;
+    long v;
+    if (!openNeighbor(m,u,wall,&v)) {return 0;}
+
+    return spreadFrom(m,u) + spreadFrom(m,v);
+}
+
+long getDMAZEdist(DMAZE *m,int row,int col)
+{
+    assert(row >= 0 && row < m->rows && col >= 0 && col < m->cols);
+    return m->dist[(long)row * m->cols + col];
+}
+
+/* Stores the cells on the path from the start to the goal in path, as
+   row*cols+col, and returns how many there are, or -1 if there is no path.
+   path must have room for the goal's distance plus one. */
+long pathDMAZE(DMAZE *m,long *path)
+{
+    long cell = getGRIDgoal(m->grid);
+    long length = m->dist[cell];
+    if (length < 0) {return -1;}
+
+    for (long i = length; i > 0; --i)
+    {
+        path[i] = cell;
+        long next;
+        for (int wall = 0; wall < 4; ++wall)
+            if (openNeighbor(m,cell,wall,&next) && m->dist[next] == i - 1)
+                break;
+        cell = next;
+    }
+    path[0] = cell;
+    return length + 1;
+}
+
+/* Writes the maze with the step values of the current path, in the same
+   format as the maze class. Every other cell has a value of -1. */
+void writeDMAZE(DMAZE *m,FILE *fp)
+{
+    for (int i = 0; i < m->rows; ++i)
+        for (int j = 0; j < m->cols; ++j)
+            setGRIDval(m->grid,i,j,-1);
+
+    long goal = getGRIDgoal(m->grid);
+    if (m->dist[goal] >= 0)
+    {
+        long *path = malloc(sizeof(long) * (m->dist[goal] + 1));
+        assert(path != 0);
+        long count = pathDMAZE(m,path);
+        for (long i = 0; i < count; ++i)
+            setGRIDval(m->grid,path[i] / m->cols,path[i] % m->cols,i % 10);
+        free(path);
+    }
+    writeGRID(m->grid,fp);
+}
+
+void freeDMAZE(DMAZE *m)
+{
+    free(m->queue);
+    free(m->seeds);
+    free(m->work);
+    free(m->affected);
+    free(m->dist);
+    freeGRID(m->grid);
+    free(m);
+}
+
+/* Reads a maze and applies each line of the edit file, "+ R C W" to add
+   wall W of cell (R,C) or "- R C W" to remove it, then writes the edited
+   maze with its path. */
+void editMAZE(FILE *mazeFile,FILE *editFile,FILE *out)
+{
+    GRID *g = readGRID(mazeFile);
+    if (g == 0) {return;}
+    DMAZE *m = newDMAZE(g);
+
+    char op;
+    int row, col, wall;
+    while (fscanf(editFile," %c %d %d %d",&op,&row,&col,&wall) == 4)
+    {
+        if (row < 0 || row >= m->rows || col < 0 || col >= m->cols) {continue;}
+        if (wall < 0 || wall > 3) {continue;}
+        if (op == '+') {addDMAZEwall(m,row,col,wall);}
+        else if (op == '-') {removeDMAZEwall(m,row,col,wall);}
+    }
+
+    writeDMAZE(m,out);
+    freeDMAZE(m);
+}
+
+/* Stores the cell through the given wall in next and returns 1 if that
+   cell is inside the maze and the wall is open. */
+static int openNeighbor(DMAZE *m,long cell,int wall,long *next)
+{
+    int row = cell / m->cols;
+    int col = cell % m->cols;
+
+    if (wall == 0)
+    {
+        if (row == 0) {return 0;}
+        *next = cell - m->cols;
+    }
+    else if (wall == 1)
+    {
+        if (col == 0) {return 0;}
+        *next = cell - 1;
+    }
+    else if (wall == 2)
+    {
+        if (col == m->cols - 1) {return 0;}
+        *next = cell + 1;
+    }
+    else // wall == 3
+    {
+        if (row == m->rows - 1) {return 0;}
+        *next = cell + m->cols;
+    }
+    return !getGRIDwall(m->grid,row,col,wall);
+}
+
+static void growList(long **list,long *cap,long need)
+{
+    if (need <= *cap) {return;}
+    long newCap = *cap ? *cap : 16;
+    while (newCap < need)
+        newCap *= 2;
+    *list = realloc(*list,sizeof(long) * newCap);
+    assert(*list != 0);
+    *cap = newCap;
+}
+
+/* Breadth-first search from the start over the whole maze. */
+static void searchAll(DMAZE *m)
+{
+    long size = (long)m->rows * m->cols;
+    for (long i = 0; i < size; ++i)
+        m->dist[i] = -1;
+
+    growList(&m->queue,&m->queueCap,size);
+    long head = 0, tail = 0;
+    long start = getGRIDstart(m->grid);
+    m->dist[start] = 0;
+    m->queue[tail++] = start;
+    while (head < tail)
+    {
+        long cell = m->queue[head++];
+        long next;
+        for (int wall = 0; wall < 4; ++wall)
+            if (openNeighbor(m,cell,wall,&next) && m->dist[next] == -1)
+            {
+                m->dist[next] = m->dist[cell] + 1;
+                m->queue[tail++] = next;
+            }
+    }
+}
+
+/* Spreads any shorter distance through cell to its neighbors, and on
+   outward for as long as it keeps improving them. Returns the number of
+   cells improved. */
+static long spreadFrom(DMAZE *m,long cell)
+{
+    if (m->dist[cell] < 0) {return 0;}
+
+    long head = 0, tail = 0;
+    long changed = 0;
+    growList(&m->queue,&m->queueCap,1);
+    m->queue[tail++] = cell;
+    while (head < tail)
+    {
+        long x = m->queue[head++];
+        long next;
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (!openNeighbor(m,x,wall,&next)) {continue;}
+            if (m->dist[next] != -1 && m->dist[next] <= m->dist[x] + 1)
+                continue;
+            m->dist[next] = m->dist[x] + 1;
+            ++changed;
+            growList(&m->queue,&m->queueCap,tail + 1);
+            m->queue[tail++] = next;
+        }
+    }
+    return changed;
+}
+
+/* Gives new distances to every cell that depended on cell to reach the
+   start. Returns the number of cells whose distance was rebuilt. */
+static long repairFrom(DMAZE *m,long cell)
+{
+    long next, other;
+
+    /* Collect the affected cells in order of distance. Every cell at one
+       distance is found before any cell at the next is checked, so a cell
+       is only affected if none of its closer neighbors are still fine. */
+    long count = 0;
+    for (int wall = 0; wall < 4; ++wall)
+        if (openNeighbor(m,cell,wall,&next) &&
+            m->dist[next] == m->dist[cell] - 1) {return 0;}
+    growList(&m->work,&m->workCap,1);
+    m->affected[cell] = 1;
+    m->work[count++] = cell;
+    for (long i = 0; i < count; ++i)
+    {
+        long x = m->work[i];
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (!openNeighbor(m,x,wall,&next)) {continue;}
+            if (m->affected[next] || m->dist[next] != m->dist[x] + 1)
+                continue;
+
+            int supported = 0;
+            for (int w = 0; w < 4 && !supported; ++w)
+                if (openNeighbor(m,next,w,&other) && !m->affected[other] &&
+                    m->dist[other] == m->dist[next] - 1) {supported = 1;}
+            if (supported) {continue;}
+
+            m->affected[next] = 1;
+            growList(&m->work,&m->workCap,count + 1);
+            m->work[count++] = next;
+        }
+    }
+
+    /* Start each affected cell from its best unaffected neighbor. */
+    long numSeeds = 0;
+    growList(&m->seeds,&m->seedsCap,count);
+    for (long i = 0; i < count; ++i)
+    {
+        long x = m->work[i];
+        m->dist[x] = -1;
+        for (int wall = 0; wall < 4; ++wall)
+            if (openNeighbor(m,x,wall,&next) && !m->affected[next] &&
+                m->dist[next] != -1 &&
+                (m->dist[x] == -1 || m->dist[next] + 1 < m->dist[x]))
+                m->dist[x] = m->dist[next] + 1;
+        if (m->dist[x] != -1) {m->seeds[numSeeds++] = x;}
+    }
+    SortDist = m->dist;
+    qsort(m->seeds,numSeeds,sizeof(long),compareDist);
+
+    /* Merge the sorted seeds with a breadth-first queue, always taking the
+       closer of the two, so each cell is settled at its final distance. */
+    growList(&m->queue,&m->queueCap,count);
+    long si = 0, head = 0, tail = 0;
+    while (si < numSeeds || head < tail)
+    {
+        long x;
+        if (head == tail ||
+            (si < numSeeds && m->dist[m->seeds[si]] <= m->dist[m->queue[head]]))
+            x = m->seeds[si++];
+        else
+            x = m->queue[head++];
+        if (m->affected[x] == 2) {continue;}
+        m->affected[x] = 2;
+
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (!openNeighbor(m,x,wall,&next) || m->affected[next] != 1)
+                continue;
+            if (m->dist[next] != -1 && m->dist[next] <= m->dist[x] + 1)
+                continue;
+            m->dist[next] = m->dist[x] + 1;
+            m->queue[tail++] = next;
+        }
+    }
+
+    for (long i = 0; i < count; ++i)
+        m->affected[m->work[i]] = 0;
+    return count;
+}
+
+static int compareDist(const void *a,const void *b)
+{
+    long da = SortDist[*(const long *)a];
+    long db = SortDist[*(const long *)b];
+    return (da > db) - (da < db);
+}
@@ -0,0 +1,18 @@
+#ifndef __DMAZE_INCLUDED__
+#define __DMAZE_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+typedef struct dmaze DMAZE;
+
+extern DMAZE *newDMAZE(GRID *g);
+extern long   addDMAZEwall(DMAZE *m,int row,int col,int wall);
+extern long   removeDMAZEwall(DMAZE *m,int row,int col,int wall);
+extern long   getDMAZEdist(DMAZE *m,int row,int col);
+extern long   pathDMAZE(DMAZE *m,long *path);
+extern void   writeDMAZE(DMAZE *m,FILE *fp);
+extern void   freeDMAZE(DMAZE *m);
+extern void   editMAZE(FILE *mazeFile,FILE *editFile,FILE *out);
+
+#endif
@@ -0,0 +1,200 @@
+/***************************************************************************
+ * This module finds the nearest of several sources for every cell of a    *
+ * maze with a single breadth-first search. All of the sources start in    *
+ * the queue at distance 0, and each cell takes the distance and the label *
+ * of whichever source reaches it first. If goals are given, the search    *
+ * stops as soon as the last of them is reached, since a breadth-first     *
+ * search never changes a distance once it is set.                         *
+ *                                                                         *
+ * floodMAZE reads the sources and goals from a file of "S R C" and        *
+ * "G R C" lines and writes the result in binary:                          *
+ *                                                                         *
+ *   "MZFL" rows cols sources labelBytes      (unsigned 32-bit integers)   *
+ *   distance of every cell, row by row      (unsigned 32-bit integers)   *
+ *   label of every cell, row by row         (labelBytes bytes each)      *
+ *                                                                         *
+ * Integers are in the byte order of the machine that wrote them. Labels   *
+ * are the index of the source in the file, and use 1, 2, or 4 bytes       *
+ * depending on the number of sources. Cells that were not reached have    *
+ * every bit of their distance and label set.                              *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "flood.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+static void writeLabels(FILE *out,unsigned int *label,long size,int bytes);
+
+/* Fills dist and label for every cell and returns the number of cells
+   reached. Sources listed twice keep their first label. */
+long floodGRID(GRID *g,long *sources,int numSources,
+               long *goals,int numGoals,
+               unsigned int *dist,unsigned int *label)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    long size = (long)rows * cols;
+
+    for (long i = 0; i < size; ++i)
+    {
+        dist[i] = FLOOD_UNREACHED;
+        label[i] = FLOOD_UNREACHED;
+    }
+
+    /* One bit per cell marks the goals that have not been reached. */
+    unsigned char *isGoal = calloc(size / 8 + 1,sizeof(unsigned char));
+    long *queue = malloc(sizeof(long) * size);
+    assert(isGoal != 0 && queue != 0);
+    int remaining = 0;
+    for (int i = 0; i < numGoals; ++i)
+        if (!(isGoal[goals[i] / 8] & (1 << (goals[i] % 8))))
+        {
+            isGoal[goals[i] / 8] |= 1 << (goals[i] % 8);
+            ++remaining;
+        }
+
+    long head = 0, tail = 0;
+    for (int i = 0; i < numSources; ++i)
+    {
+        long s = sources[i];
+        if (dist[s] != FLOOD_UNREACHED) {continue;}
+        dist[s] = 0;
+        label[s] = i;
+        queue[tail++] = s;
+        if (isGoal[s / 8] & (1 << (s % 8)))
+        {
+            isGoal[s / 8] &= ~(1 << (s % 8));
+            --remaining;
+        }
+    }
+
+    while (head < tail && (numGoals == 0 || remaining > 0))
+    {
+        long cell = queue[head++];
+        int row = cell / cols;
+        int col = cell % cols;
+        long next[4] = {cell - cols,cell - 1,cell + 1,cell + cols};
+        int inside[4] = {row > 0,col > 0,col < cols - 1,row < rows - 1};
+
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            long n = next[wall];
+            if (!inside[wall] || getGRIDwall(g,row,col,wall)) {continue;}
+            if (dist[n] != FLOOD_UNREACHED) {continue;}
+            dist[n] = dist[cell] + 1;
+            label[n] = label[cell];
+            queue[tail++] = n;
+            if (isGoal[n / 8] & (1 << (n % 8)))
+            {
+                isGoal[n / 8] &= ~(1 << (n % 8));
+                --remaining;
+            }
+        }
+    }
+
+    free(queue);
+    free(isGoal);
+    return tail;
+}
+
+/* Returns 0 if the maze or the points could not be read. */
+int floodMAZE(FILE *mazeFile,FILE *pointsFile,FILE *out)
+{
+    GRID *g = readGRID(mazeFile);
+    if (g == 0) {return 0;}
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    long size = (long)rows * cols;
+
+    int numSources = 0, numGoals = 0;
+    int capSources = 16, capGoals = 16;
+    long *sources = malloc(sizeof(long) * capSources);
+    long *goals = malloc(sizeof(long) * capGoals);
+    assert(sources != 0 && goals != 0);
+
+    char kind;
+    int row, col;
+    while (fscanf(pointsFile," %c %d %d",&kind,&row,&col) == 3)
+    {
+        if (row < 0 || row >= rows || col < 0 || col >= cols) {continue;}
+        long cell = (long)row * cols + col;
+        if (kind == 'S')
+        {
+            if (numSources == capSources)
+            {
+                capSources *= 2;
+                sources = realloc(sources,sizeof(long) * capSources);
+                assert(sources != 0);
+            }
+            sources[numSources++] = cell;
+        }
+        else if (kind == 'G')
+        {
+            if (numGoals == capGoals)
+            {
+                capGoals *= 2;
+                goals = realloc(goals,sizeof(long) * capGoals);
+                assert(goals != 0);
+            }
+            goals[numGoals++] = cell;
+        }
+    }
+    if (numSources == 0)
+    {
+        free(goals);
+        free(sources);
+        freeGRID(g);
+        return 0;
+    }
+
+    unsigned int *dist = malloc(sizeof(unsigned int) * size);
+    unsigned int *label = malloc(sizeof(unsigned int) * size);
+    assert(dist != 0 && label != 0);
+    floodGRID(g,sources,numSources,goals,numGoals,dist,label);
+
+    /* The label of an unreached cell must not look like a source. */
+    int labelBytes = numSources < 0xFF ? 1 : numSources < 0xFFFF ? 2 : 4;
+    uint32_t header[4] = {rows,cols,numSources,labelBytes};
+    fwrite("MZFL",1,4,out);
+    fwrite(header,sizeof(uint32_t),4,out);
+    fwrite(dist,sizeof(unsigned int),size,out);
+    writeLabels(out,label,size,labelBytes);
+
+    free(label);
+    free(dist);
+    free(goals);
+    free(sources);
+    freeGRID(g);
+    return 1;
+}
+
+/* Writes each label narrowed to the given number of bytes, a block at a
+   time so the narrowed copy never needs to be the size of the maze. */
+static void writeLabels(FILE *out,unsigned int *label,long size,int bytes)
+{
+    if (bytes == 4)
+    {
+        fwrite(label,sizeof(unsigned int),size,out);
+        return;
+    }
+
+    enum {BLOCK = 4096};
+    uint8_t small[BLOCK];
+    uint16_t medium[BLOCK];
+    for (long start = 0; start < size; start += BLOCK)
+    {
+        long count = size - start < BLOCK ? size - start : BLOCK;
+        for (long i = 0; i < count; ++i)
+        {
+            if (bytes == 1) {small[i] = (uint8_t)label[start + i];}
+            else {medium[i] = (uint16_t)label[start + i];}
+        }
+        if (bytes == 1) {fwrite(small,1,count,out);}
+        else {fwrite(medium,2,count,out);}
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef __FLOOD_INCLUDED__
+#define __FLOOD_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+#define FLOOD_UNREACHED 0xFFFFFFFFu
+
+extern long floodGRID(GRID *g,long *sources,int numSources,
+                      long *goals,int numGoals,
+                      unsigned int *dist,unsigned int *label);
+extern int  floodMAZE(FILE *mazeFile,FILE *pointsFile,FILE *out);
+
+#endif
@@ -0,0 +1,513 @@
+/***************************************************************************
+ * This grid class is a compact alternative to the maze class for the      *
+ * generators and solvers that work on large mazes. Instead of allocating  *
+ * a cell structure per cell, the walls of every cell are packed into the  *
+ * low four bits of a single byte stored in one flat array. Two of the     *
+ * spare bits hold a direction that algorithms may use to remember one     *
+ * neighbor per cell. Cell values are only allocated once a value other    *
+ * than -1 is set, and cell costs once a cost other than 1 is set. Grids   *
+ * are read and written in the same file format as the maze class. If a    *
+ * grid has costs, they follow the maze in the file as the word "costs"    *
+ * and one line of costs per row. Readers of the maze format stop before   *
+ * this block, so weighted mazes can still be drawn and solved as usual.   *
+ *                                                                         *
+ * The entrance and exit are the first and last cells unless the grid has  *
+ * been given other ends, which are then written as the line               *
+ * "ends R1 C1 R2 C2" after the maze and any costs.                        *
+ *                                                                         *
+ * Grids can also be written in a binary format, in which every cell is    *
+ * at a fixed offset so that a file can be patched in place. readGRID      *
+ * reads it, and the compressed archives written by the arch module, by    *
+ * their four byte magic, "MZGD" or "MZAR", where a text maze starts with  *
+ * its size.                                                               *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "grid.h"
+#include "arch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+// Necissary for random() and srandom() to work.
+long int random(void);
+void srandom(unsigned int seed);
+
+/* Mixed into the seed for costs, the golden ratio in 32 bits. */
+#define COST_SEED_MIX 0x9E3779B9u
+
+struct grid
+{
+    /* Bit w of a cell is set while wall w of that cell is standing. Bits 4
+       and 5 hold the cell's direction. */
+    unsigned char *cells;
+    int *values;
+    /* Cost of moving into each cell, from 1 to 255. */
+    unsigned char *costs;
+    int rows;
+    int cols;
+    /* Cell indices of the entrance and exit. */
+    long start;
+    long goal;
+};
+
+static long cellIndex(GRID *g,int row,int col);
+static int  neighborIndex(GRID *g,int row,int col,int wall,long *index);
+static GRID *readArchive(FILE *fp);
+static GRID *readBinary(FILE *fp);
+
+GRID *newGRID(int rows,int cols)
+{
+    assert(rows > 0 && cols > 0);
+
+    GRID *g = (GRID *)malloc(sizeof(GRID));
+    assert(g != 0);
+
+    long size = (long)rows * cols;
+    g->cells = malloc(sizeof(unsigned char) * size);
+    assert(g->cells != 0);
+    for (long i = 0; i < size; ++i)
+        g->cells[i] = 0xF;
+
+    g->values = 0;
+    g->costs = 0;
+    g->rows = rows;
+    g->cols = cols;
+    g->start = 0;
+    g->goal = size - 1;
+
+    return g;
+}
+
+int getGRIDrows(GRID *g) {return g->rows;}
+
+int getGRIDcols(GRID *g) {return g->cols;}
+
+int getGRIDwall(GRID *g,int row,int col,int wall)
+{
+    /* |---|---|---|
+       |   |   |   |
+       |---|-0-|---|
+       |   1 X 2   |
+       |---|-3-|---|
+       |   |   |   |
+       |---|---|---| */
+
+    assert(wall >= 0 && wall <= 3);
+    return (g->cells[cellIndex(g,row,col)] >> wall) & 1;
+}
+
+/* Returns the four wall bits of a cell, with bit w set if wall w stands. */
+int getGRIDwalls(GRID *g,int row,int col)
+{
+    return g->cells[cellIndex(g,row,col)] & 0xF;
+}
+
+void removeGRIDwall(GRID *g,int row,int col,int wall)
+{
+    /* Removing an interior wall also removes the matching wall of the
+       neighboring cell so both sides always agree. */
+    assert(wall >= 0 && wall <= 3);
+    long neighbor;
+
+    g->cells[cellIndex(g,row,col)] &= ~(1 << wall);
+    if (neighborIndex(g,row,col,wall,&neighbor))
+        g->cells[neighbor] &= ~(1 << (3 - wall));
+}
+
+void addGRIDwall(GRID *g,int row,int col,int wall)
+{
+    assert(wall >= 0 && wall <= 3);
+    long neighbor;
+
+    g->cells[cellIndex(g,row,col)] |= 1 << wall;
+    if (neighborIndex(g,row,col,wall,&neighbor))
+        g->cells[neighbor] |= 1 << (3 - wall);
+}
+
+int getGRIDval(GRID *g,int row,int col)
+{
+    if (g->values == 0) {return -1;}
+    return g->values[cellIndex(g,row,col)];
+}
+
+void setGRIDval(GRID *g,int row,int col,int value)
+{
+    /* Values are allocated lazily so unsolved grids stay one byte a cell. */
+    if (g->values == 0)
+    {
+        if (value == -1) {return;}
+        long size = (long)g->rows * g->cols;
+        g->values = malloc(sizeof(int) * size);
+        assert(g->values != 0);
+        for (long i = 0; i < size; ++i)
+            g->values[i] = -1;
+    }
+    g->values[cellIndex(g,row,col)] = value;
+}
+
+int getGRIDcost(GRID *g,int row,int col)
+{
+    if (g->costs == 0) {return 1;}
+    return g->costs[cellIndex(g,row,col)];
+}
+
+void setGRIDcost(GRID *g,int row,int col,int cost)
+{
+    assert(cost >= 1 && cost <= 255);
+    if (g->costs == 0)
+    {
+        if (cost == 1) {return;}
+        long size = (long)g->rows * g->cols;
+        g->costs = malloc(sizeof(unsigned char) * size);
+        assert(g->costs != 0);
+        memset(g->costs,1,size);
+    }
+    g->costs[cellIndex(g,row,col)] = cost;
+}
+
+int hasGRIDcosts(GRID *g) {return g->costs != 0;}
+
+/* Appends a block of random costs from 1 to maxCost to a maze file, so
+   this works after any generator. The generators seed random() with the
+   same seed, so the costs are drawn from a different seed made from it;
+   otherwise they would replay the numbers that carved the walls. */
+void writeCOSTS(int rows,int cols,int maxCost,int randSeed,FILE *fp)
+{
+    assert(maxCost >= 1 && maxCost <= 255);
+    srandom((unsigned int)randSeed ^ COST_SEED_MIX);
+
+    fprintf(fp,"costs\n");
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            fprintf(fp,"%ld",1 + random() % maxCost);
+            if (j < cols - 1) {fprintf(fp," ");}
+        }
+        fprintf(fp,"\n");
+    }
+}
+
+long getGRIDstart(GRID *g) {return g->start;}
+
+long getGRIDgoal(GRID *g) {return g->goal;}
+
+/* Moves the entrance and exit. The outer wall is opened for an end on the
+   left or right edge of the grid, which is where the maze format can show
+   it, and closed where the old ends were. */
+void setGRIDends(GRID *g,int startRow,int startCol,int goalRow,int goalCol)
+{
+    long ends[2] = {g->start,g->goal};
+    for (int k = 0; k < 2; ++k)
+    {
+        int row = ends[k] / g->cols, col = ends[k] % g->cols;
+        if (col == 0) {addGRIDwall(g,row,col,1);}
+        if (col == g->cols - 1) {addGRIDwall(g,row,col,2);}
+    }
+
+    g->start = cellIndex(g,startRow,startCol);
+    g->goal = cellIndex(g,goalRow,goalCol);
+
+    if (startCol == 0) {removeGRIDwall(g,startRow,startCol,1);}
+    else if (startCol == g->cols - 1) {removeGRIDwall(g,startRow,startCol,2);}
+    if (goalCol == g->cols - 1) {removeGRIDwall(g,goalRow,goalCol,2);}
+    else if (goalCol == 0) {removeGRIDwall(g,goalRow,goalCol,1);}
+}
+
+/* Moves the entrance and exit without touching any wall, as readGRID does
+   for an ends line. */
+void placeGRIDends(GRID *g,long start,long goal)
+{
+    assert(start >= 0 && start < (long)g->rows * g->cols);
+    assert(goal >= 0 && goal < (long)g->rows * g->cols);
+    g->start = start;
+    g->goal = goal;
+}
+
+int getGRIDdir(GRID *g,int row,int col)
+{
+    return (g->cells[cellIndex(g,row,col)] >> 4) & 3;
+}
+
+void setGRIDdir(GRID *g,int row,int col,int dir)
+{
+    assert(dir >= 0 && dir <= 3);
+    long i = cellIndex(g,row,col);
+    g->cells[i] = (g->cells[i] & ~0x30) | (dir << 4);
+}
+
+void writeGRID(GRID *g,FILE *fp)
+{
+    /*
+    *  Grid will be stored in a file with the following format:
+    *
+    *  rows cols
+    *  left value left value left value right
+    *  bottom bottom bottom
+    *  left value left value left value right
+    *  bottom bottom bottom
+    *  left value left value left value right
+    *
+    *  followed, only if the grid has costs, by:
+    *
+    *  costs
+    *  cost cost cost
+    *  cost cost cost
+    *  cost cost cost
+    *
+    *  and then, only if the entrance and exit have been moved, by:
+    *
+    *  ends startRow startCol goalRow goalCol
+    */
+
+    fprintf(fp,"%d %d\n",g->rows,g->cols);
+    for (int i = 0; i < g->rows; ++i)
+    {
+        for (int j = 0; j < g->cols; ++j)
+        {
+            fprintf(fp,"%d ",getGRIDwall(g,i,j,1));
+            fprintf(fp,"%d ",getGRIDval(g,i,j));
+        }
+        fprintf(fp,"%d\n",getGRIDwall(g,i,g->cols-1,2));
+
+        if (i < g->rows - 1)
+        {
+            for (int j = 0; j < g->cols; ++j)
+            {
+                fprintf(fp,"%d",getGRIDwall(g,i,j,3));
+                if (j < g->cols - 1) {fprintf(fp," ");}
+            }
+            fprintf(fp,"\n");
+        }
+    }
+
+    if (g->costs)
+    {
+        fprintf(fp,"costs\n");
+        for (int i = 0; i < g->rows; ++i)
+        {
+            for (int j = 0; j < g->cols; ++j)
+            {
+                fprintf(fp,"%d",getGRIDcost(g,i,j));
+                if (j < g->cols - 1) {fprintf(fp," ");}
+            }
+            fprintf(fp,"\n");
+        }
+    }
+
+    if (g->start != 0 || g->goal != (long)g->rows * g->cols - 1)
+        fprintf(fp,"ends %ld %ld %ld %ld\n",g->start / g->cols,
+            g->start % g->cols,g->goal / g->cols,g->goal % g->cols);
+}
+
+GRID *readGRID(FILE *fp)
+{
+    int rows = 0, cols = 0;
+    int wall = 0, value = 0;
+    int first = getc(fp);
+    ungetc(first,fp);
+    if (first == 'M')
+    {
+        char magic[4];
+        if (fread(magic,1,4,fp) != 4) {return 0;}
+        return readGRIDmagic(fp,magic);
+    }
+    if (fscanf(fp,"%d %d",&rows,&cols) != 2) {return 0;}
+    GRID *g = newGRID(rows,cols);
+
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            fscanf(fp,"%d",&wall);
+            if (!wall) {removeGRIDwall(g,i,j,1);}
+            fscanf(fp,"%d",&value);
+            setGRIDval(g,i,j,value);
+        }
+        fscanf(fp,"%d",&wall);
+        if (!wall) {removeGRIDwall(g,i,cols-1,2);}
+
+        if (i < rows - 1)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                fscanf(fp,"%d",&wall);
+                if (!wall) {removeGRIDwall(g,i,j,3);}
+            }
+        }
+    }
+
+    char word[8];
+    int cost = 1;
+    while (fscanf(fp,"%7s",word) == 1)
+    {
+        if (strcmp(word,"costs") == 0)
+        {
+            for (int i = 0; i < rows; ++i)
+                for (int j = 0; j < cols; ++j)
+                {
+                    fscanf(fp,"%d",&cost);
+                    if (cost < 1) {cost = 1;}
+                    if (cost > 255) {cost = 255;}
+                    setGRIDcost(g,i,j,cost);
+                }
+        }
+        else if (strcmp(word,"ends") == 0)
+        {
+            int ends[4] = {0,0,rows-1,cols-1};
+            for (int k = 0; k < 4; ++k) {fscanf(fp,"%d",&ends[k]);}
+            if (ends[0] >= 0 && ends[0] < rows && ends[1] >= 0
+                && ends[1] < cols && ends[2] >= 0 && ends[2] < rows
+                && ends[3] >= 0 && ends[3] < cols)
+            {
+                g->start = cellIndex(g,ends[0],ends[1]);
+                g->goal = cellIndex(g,ends[2],ends[3]);
+            }
+        }
+        else {break;}
+    }
+    return g;
+}
+
+/* Writes the grid in the binary format read by readGRID, in which every
+   cell is at a fixed offset so it can be changed in place:
+
+     "MZGD" rows cols flags        (unsigned 32-bit)
+     start goal                    (unsigned 64-bit)
+     the walls of each cell        (one byte each)
+     the value of each cell        (signed 32-bit)
+     the cost of each cell         (one byte each, only if flags is 1)
+
+   Integers are in the byte order of the machine that wrote them. */
+void writeGRIDbinary(GRID *g,FILE *fp)
+{
+    long size = (long)g->rows * g->cols;
+    uint32_t header[3] = {g->rows,g->cols,g->costs != 0};
+    uint64_t ends[2] = {g->start,g->goal};
+    fwrite("MZGD",1,4,fp);
+    fwrite(header,sizeof(uint32_t),3,fp);
+    fwrite(ends,sizeof(uint64_t),2,fp);
+    for (long i = 0; i < size; ++i) {putc(g->cells[i] & 0xF,fp);}
+    for (long i = 0; i < size; ++i)
+    {
+        int32_t value = g->values ? g->values[i] : -1;
+        fwrite(&value,sizeof(int32_t),1,fp);
+    }
+    if (g->costs) {fwrite(g->costs,1,size,fp);}
+}
+
+/* Reads the rest of a binary grid or archive whose four byte magic has
+   already been read. Returns 0 for any other magic. */
+GRID *readGRIDmagic(FILE *fp,const char *magic)
+{
+    if (memcmp(magic,"MZGD",4) == 0) {return readBinary(fp);}
+    if (memcmp(magic,"MZAR",4) == 0) {return readArchive(fp);}
+    return 0;
+}
+
+static GRID *readBinary(FILE *fp)
+{
+    uint32_t header[3];
+    uint64_t ends[2];
+    if (fread(header,sizeof(uint32_t),3,fp) != 3 ||
+        fread(ends,sizeof(uint64_t),2,fp) != 2) {return 0;}
+    if (header[0] == 0 || header[1] == 0) {return 0;}
+
+    GRID *g = newGRID(header[0],header[1]);
+    long size = (long)g->rows * g->cols;
+    int ok = fread(g->cells,1,size,fp) == (size_t)size;
+    for (long i = 0; ok && i < size; ++i)
+    {
+        int32_t value;
+        ok = fread(&value,sizeof(int32_t),1,fp) == 1;
+        if (ok && value != -1) {setGRIDval(g,i / g->cols,i % g->cols,value);}
+    }
+    if (ok && header[2] & 1)
+    {
+        g->costs = malloc(size);
+        assert(g->costs != 0);
+        ok = fread(g->costs,1,size,fp) == (size_t)size;
+    }
+    if (!ok)
+    {
+        freeGRID(g);
+        return 0;
+    }
+    if (ends[0] < (uint64_t)size && ends[1] < (uint64_t)size)
+    {
+        g->start = ends[0];
+        g->goal = ends[1];
+    }
+    return g;
+}
+
+/* Archives hold walls in the same bits as the cells, so each block is
+   decoded straight into place. */
+static GRID *readArchive(FILE *fp)
+{
+    ARCHIVE *a = openARCHIVEheader(fp);
+    if (a == 0) {return 0;}
+    GRID *g = newGRID(getARCHIVErows(a),getARCHIVEcols(a));
+    long size = (long)g->rows * g->cols;
+    long done = 0;
+    int count;
+    while ((count = nextARCHIVEblock(a,g->cells + done)) > 0)
+        done += (long)count * g->cols;
+    if (count < 0 || done != size)
+    {
+        closeARCHIVE(a);
+        freeGRID(g);
+        return 0;
+    }
+    if (getARCHIVEstart(a) < size && getARCHIVEgoal(a) < size)
+    {
+        g->start = getARCHIVEstart(a);
+        g->goal = getARCHIVEgoal(a);
+    }
+    closeARCHIVE(a);
+    return g;
+}
+
+void freeGRID(GRID *g)
+{
+    free(g->costs);
+    free(g->values);
+    free(g->cells);
+    free(g);
+}
+
+static long cellIndex(GRID *g,int row,int col)
+{
+    assert(row >= 0 && row < g->rows && col >= 0 && col < g->cols);
+    return (long)row * g->cols + col;
+}
+
+/* Stores the index of the cell on the other side of the given wall and
+   returns 1, or returns 0 if the wall is on the edge of the grid. */
+static int neighborIndex(GRID *g,int row,int col,int wall,long *index)
+{
+    if (wall == 0)
+    {
+        if (row == 0) {return 0;}
+        *index = cellIndex(g,row-1,col);
+    }
+    else if (wall == 1)
+    {
+        if (col == 0) {return 0;}
+        *index = cellIndex(g,row,col-1);
+    }
+    else if (wall == 2)
+    {
+        if (col == g->cols - 1) {return 0;}
+        *index = cellIndex(g,row,col+1);
+    }
+    else // wall == 3
+    {
+        if (row == g->rows - 1) {return 0;}
+        *index = cellIndex(g,row+1,col);
+    }
+    return 1;
+}
@@ -0,0 +1,36 @@
+#ifndef __GRID_INCLUDED__
+#define __GRID_INCLUDED__
+
+#include <stdio.h>
+
+#define GRID_HEADER_BYTES 32
+
+typedef struct grid GRID;
+
+extern GRID *newGRID(int rows,int cols);
+extern int   getGRIDrows(GRID *g);
+extern int   getGRIDcols(GRID *g);
+extern int   getGRIDwall(GRID *g,int row,int col,int wall);
+extern int   getGRIDwalls(GRID *g,int row,int col);
+extern void  removeGRIDwall(GRID *g,int row,int col,int wall);
+extern void  addGRIDwall(GRID *g,int row,int col,int wall);
+extern int   getGRIDval(GRID *g,int row,int col);
+extern void  setGRIDval(GRID *g,int row,int col,int value);
+extern int   getGRIDcost(GRID *g,int row,int col);
+extern void  setGRIDcost(GRID *g,int row,int col,int cost);
+extern int   hasGRIDcosts(GRID *g);
+extern void  writeCOSTS(int rows,int cols,int maxCost,int randSeed,FILE *fp);
+extern long  getGRIDstart(GRID *g);
+extern long  getGRIDgoal(GRID *g);
+extern void  setGRIDends(GRID *g,int startRow,int startCol,
+                 int goalRow,int goalCol);
+extern void  placeGRIDends(GRID *g,long start,long goal);
+extern int   getGRIDdir(GRID *g,int row,int col);
+extern void  setGRIDdir(GRID *g,int row,int col,int dir);
+extern void  writeGRID(GRID *g,FILE *fp);
+extern GRID *readGRID(FILE *fp);
+extern void  writeGRIDbinary(GRID *g,FILE *fp);
+extern GRID *readGRIDmagic(FILE *fp,const char *magic);
+extern void  freeGRID(GRID *g);
+
+#endif
@@ -0,0 +1,129 @@
+/***************************************************************************
+ * This module generates mazes with a randomized version of Kruskal's      *
+ * algorithm. Every interior wall is an edge between two cells. The edges  *
+ * are shuffled and each one is removed when the cells it separates are    *
+ * not yet connected, which is checked with a union-find over flat arrays. *
+ * Unlike the depth-first search in the maze class, no stack is needed so  *
+ * memory use is fixed by the size of the maze: four bytes per edge, five  *
+ * bytes per cell for the union-find, and one byte per cell for the grid.  *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "kruskal.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+// Necissary for random() and srandom() to work.
+long int random(void);
+void srandom(unsigned int seed);
+
+static long randomIndex(long n);
+static int  findSET(int *parent,int x);
+static int  unionSETS(int *parent,unsigned char *rank,int x,int y);
+
+GRID *generateKRUSKAL(int rows,int cols,int randSeed)
+{
+    assert(rows > 0 && cols > 0);
+    assert((long)rows * cols <= INT_MAX / 2);
+
+    srandom(randSeed);
+    int size = rows * cols;
+    GRID *g = newGRID(rows,cols);
+
+    /* Edge e joins cell e/2 to its right neighbor when e is even and to its
+       bottom neighbor when e is odd. The edges are shuffled as they are
+       generated (inside-out Fisher-Yates) so the array is only filled once. */
+    long numEdges = (long)rows * (cols - 1) + (long)(rows - 1) * cols;
+    unsigned int *edges = malloc(sizeof(unsigned int) * (numEdges + 1));
+    assert(edges != 0);
+    long count = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        for (int dir = 0; dir < 2; ++dir)
+        {
+            if (dir == 0 && i % cols == cols - 1) {continue;}
+            if (dir == 1 && i / cols == rows - 1) {continue;}
+            long j = randomIndex(count + 1);
+            edges[count] = edges[j];
+            edges[j] = (unsigned int)i * 2 + dir;
+            ++count;
+        }
+    }
+
+    int *parent = malloc(sizeof(int) * size);
+    unsigned char *rank = calloc(size,sizeof(unsigned char));
+    assert(parent != 0 && rank != 0);
+    for (int i = 0; i < size; ++i)
+        parent[i] = i;
+
+    /* A spanning tree has exactly size-1 edges, so stop once it is found. */
+    int joined = 0;
+    for (long e = 0; e < numEdges && joined < size - 1; ++e)
+    {
+        int cell = edges[e] / 2;
+        int next = (edges[e] & 1) ? cell + cols : cell + 1;
+        if (unionSETS(parent,rank,cell,next))
+        {
+            removeGRIDwall(g,cell / cols,cell % cols,(edges[e] & 1) ? 3 : 2);
+            ++joined;
+        }
+    }
+
+    free(rank);
+    free(parent);
+    free(edges);
+
+    removeGRIDwall(g,0,0,1);
+    removeGRIDwall(g,rows-1,cols-1,2);
+    return g;
+}
+
+void createKRUSKAL(int rows,int cols,int randSeed,FILE *fp)
+{
+    GRID *g = generateKRUSKAL(rows,cols,randSeed);
+    writeGRID(g,fp);
+    freeGRID(g);
+}
+
+/* Returns a random index in [0,n). random() only gives 31 bits, so two
+   calls are combined for edge counts larger than that. */
+static long randomIndex(long n)
+{
+    if (n <= RAND_MAX) {return random() % n;}
+    unsigned long r = ((unsigned long)random() << 31) | random();
+    return (long)(r % n);
+}
+
+/* Finds the root of x, pointing every other node on the way at its
+   grandparent (path halving). */
+static int findSET(int *parent,int x)
+{
+    while (parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/* Joins the sets holding x and y by rank. Returns 0 if they were already
+   the same set. */
+static int unionSETS(int *parent,unsigned char *rank,int x,int y)
+{
+    x = findSET(parent,x);
+    y = findSET(parent,y);
+    if (x == y) {return 0;}
+
+    if (rank[x] < rank[y]) {parent[x] = y;}
+    else if (rank[x] > rank[y]) {parent[y] = x;}
+    else
+    {
+        parent[y] = x;
+        rank[x]++;
+    }
+    return 1;
+}
@@ -0,0 +1,10 @@
+#ifndef __KRUSKAL_INCLUDED__
+#define __KRUSKAL_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+extern GRID *generateKRUSKAL(int rows,int cols,int randSeed);
+extern void  createKRUSKAL(int rows,int cols,int randSeed,FILE *fp);
+
+#endif
@@ -0,0 +1,200 @@
+/***************************************************************************
+ * This lca class answers many path queries against one perfect maze. A    *
+ * perfect maze is a tree, so the path between two cells is unique and     *
+ * goes through their lowest common ancestor when the tree is rooted at    *
+ * the first cell. A single breadth-first search records each cell's      *
+ * parent and depth, along with a jump pointer (Myers' skew-binary jumps)  *
+ * that lets any ancestor be found in O(log n) steps while using only one  *
+ * extra integer per cell. The distance between two cells is then their   *
+ * depths minus twice the depth of their common ancestor, and the path is  *
+ * found by walking both cells up to it, which costs the path's length.    *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "lca.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+struct lca
+{
+    int rows;
+    int cols;
+    int *parent;
+    int *jump;
+    int *depth;
+};
+
+static int findAncestor(LCA *t,int cell,int depth);
+static int findLCA(LCA *t,int a,int b);
+
+LCA *newLCA(GRID *g)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    assert((long)rows * cols <= INT_MAX);
+    int size = rows * cols;
+
+    LCA *t = malloc(sizeof(LCA));
+    assert(t != 0);
+    t->rows = rows;
+    t->cols = cols;
+    t->parent = malloc(sizeof(int) * size);
+    t->jump = malloc(sizeof(int) * size);
+    t->depth = malloc(sizeof(int) * size);
+    assert(t->parent != 0 && t->jump != 0 && t->depth != 0);
+    for (int i = 0; i < size; ++i)
+        t->depth[i] = -1;
+
+    /* A cell's jump depends only on its parent's, so it is filled in as
+       soon as the cell is reached. */
+    int *queue = malloc(sizeof(int) * size);
+    assert(queue != 0);
+    int head = 0, tail = 0;
+    long edges = 0;
+    t->depth[0] = 0;
+    t->parent[0] = 0;
+    t->jump[0] = 0;
+    queue[tail++] = 0;
+    while (head < tail)
+    {
+        int cell = queue[head++];
+        int row = cell / cols, col = cell % cols;
+        int next[4] = {cell - cols,cell - 1,cell + 1,cell + cols};
+        int inside[4] = {row > 0,col > 0,col < cols - 1,row < rows - 1};
+        int jp = t->jump[cell];
+        int jjp = t->jump[jp];
+        int skip = t->depth[cell] - t->depth[jp] == t->depth[jp] - t->depth[jjp];
+
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (!inside[wall] || getGRIDwall(g,row,col,wall)) {continue;}
+            ++edges;
+            int child = next[wall];
+            if (t->depth[child] != -1) {continue;}
+            t->depth[child] = t->depth[cell] + 1;
+            t->parent[child] = cell;
+            t->jump[child] = skip ? jjp : cell;
+            queue[tail++] = child;
+        }
+    }
+    free(queue);
+
+    /* Every open wall was counted from both sides. A tree that reaches every
+       cell has exactly size-1 of them. */
+    if (tail != size || edges / 2 != size - 1)
+    {
+        freeLCA(t);
+        return 0;
+    }
+
+    return t;
+}
+
+long distanceLCA(LCA *t,int r1,int c1,int r2,int c2)
+{
+    assert(r1 >= 0 && r1 < t->rows && c1 >= 0 && c1 < t->cols);
+    assert(r2 >= 0 && r2 < t->rows && c2 >= 0 && c2 < t->cols);
+    int a = r1 * t->cols + c1;
+    int b = r2 * t->cols + c2;
+    int ancestor = findLCA(t,a,b);
+    return (long)t->depth[a] + t->depth[b] - 2L * t->depth[ancestor];
+}
+
+/* Stores the cells on the path from (r1,c1) to (r2,c2) in path, as
+   row*cols+col, and returns how many there are. path must have room for
+   distanceLCA()+1 cells. */
+long pathLCA(LCA *t,int r1,int c1,int r2,int c2,long *path)
+{
+    int a = r1 * t->cols + c1;
+    int b = r2 * t->cols + c2;
+    int ancestor = findLCA(t,a,b);
+    long up = t->depth[a] - t->depth[ancestor];
+    long length = up + t->depth[b] - t->depth[ancestor];
+
+    for (long i = 0; i <= up; ++i, a = t->parent[a])
+        path[i] = a;
+    for (long i = length; i > up; --i, b = t->parent[b])
+        path[i] = b;
+    return length + 1;
+}
+
+void freeLCA(LCA *t)
+{
+    free(t->depth);
+    free(t->jump);
+    free(t->parent);
+    free(t);
+}
+
+/* Reads a maze and answers each "r1 c1 r2 c2" line of the query file with
+   a line holding the distance followed by the row and column of every cell
+   on the path. Returns 0 if the maze is not a perfect maze. */
+int queryMAZE(FILE *mazeFile,FILE *queryFile,FILE *out)
+{
+    GRID *g = readGRID(mazeFile);
+    if (g == 0) {return 0;}
+    LCA *t = newLCA(g);
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    freeGRID(g);
+    if (t == 0) {return 0;}
+
+    long *path = malloc(sizeof(long) * rows * cols);
+    assert(path != 0);
+
+    int r1, c1, r2, c2;
+    while (fscanf(queryFile,"%d %d %d %d",&r1,&c1,&r2,&c2) == 4)
+    {
+        if (r1 < 0 || r1 >= rows || c1 < 0 || c1 >= cols ||
+            r2 < 0 || r2 >= rows || c2 < 0 || c2 >= cols)
+        {
+            fprintf(out,"-1\n");
+            continue;
+        }
+        long count = pathLCA(t,r1,c1,r2,c2,path);
+        fprintf(out,"%ld",count - 1);
+        for (long i = 0; i < count; ++i)
+            fprintf(out," %ld %ld",path[i] / cols,path[i] % cols);
+        fprintf(out,"\n");
+    }
+
+    free(path);
+    freeLCA(t);
+    return 1;
+}
+
+/* Returns the ancestor of cell at the given depth. */
+static int findAncestor(LCA *t,int cell,int depth)
+{
+    while (t->depth[cell] > depth)
+    {
+        if (t->depth[t->jump[cell]] >= depth) {cell = t->jump[cell];}
+        else {cell = t->parent[cell];}
+    }
+    return cell;
+}
+
+static int findLCA(LCA *t,int a,int b)
+{
+    if (t->depth[a] > t->depth[b]) {a = findAncestor(t,a,t->depth[b]);}
+    else {b = findAncestor(t,b,t->depth[a]);}
+
+    while (a != b)
+    {
+        if (t->jump[a] != t->jump[b])
+        {
+            a = t->jump[a];
+            b = t->jump[b];
+        }
+        else
+        {
+            a = t->parent[a];
+            b = t->parent[b];
+        }
+    }
+    return a;
+}
@@ -0,0 +1,15 @@
+#ifndef __LCA_INCLUDED__
+#define __LCA_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+typedef struct lca LCA;
+
+extern LCA  *newLCA(GRID *g);
+extern long  distanceLCA(LCA *t,int r1,int c1,int r2,int c2);
+extern long  pathLCA(LCA *t,int r1,int c1,int r2,int c2,long *path);
+extern void  freeLCA(LCA *t);
+extern int   queryMAZE(FILE *mazeFile,FILE *queryFile,FILE *out);
+
+#endif
@@ -13,10 +13,16 @@
 #include "cell.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <assert.h>
 #include "stack.h"
 #include "queue.h"
 #include "da.h"
+#include "grid.h"
+#include "arch.h"
+#include "rows.h"
+#include "smaze.h"
 
 // Necissary for random() and srandom() to work.
 long int random(void);
@@ -27,15 +33,33 @@ struct maze
     CELL ***cells;
     int rows;
     int cols;
+    /* Bit w is set in both masks when a cell in that row and column has a
+       neighbor through wall w, so edge checks are one table lookup. */
+    unsigned char *rowMask;
+    unsigned char *colMask;
+    /* Entrance and exit, the first and last cells unless the file has an
+       ends line. */
+    int startRow, startCol;
+    int goalRow, goalCol;
 };
 
+static int RowStep[4] = {-1,0,0,1};
+static int ColStep[4] = {0,-1,1,0};
+
 static MAZE *newMAZE(int rows,int cols);
 static DA *makePosWallsArray(MAZE *m,int curRow,int curCol);
 static void writeMAZE(MAZE *m,FILE *fp);
 static MAZE *readMAZE(FILE *fp);
+static MAZE *readBinary(FILE *fp);
+static GRID *readMagic(FILE *fp,const char *magic);
+static int  drawBinary(FILE *fp);
+static void drawRow(unsigned char *walls,int *values,int cols,int last);
 static int isWallEligible(MAZE *m,CELL *c,int wall);
 static int isPathClear(MAZE *m,CELL *c,int wall);
 static void freeMAZE(MAZE *m);
+static void setDistance(MAZE *m,uint32_t *dist,CELL *from,CELL *to);
+static void writeDistances(uint32_t *dist,int rows,int cols,int varint,
+                           FILE *fp);
 
 void createMAZE(int rows,int cols,int randSeed,FILE *fp)
 {
@@ -105,7 +129,8 @@ void createMAZE(int rows,int cols,int randSeed,FILE *fp)
     freeMAZE(m);
 }
 
-void drawMAZE(FILE *fp)
+/* Returns 0 if a binary file isn't a maze. */
+int drawMAZE(FILE *fp)
 {
     /* Maze will be stored in a file with the following format:
 
@@ -133,6 +158,9 @@ void drawMAZE(FILE *fp)
     int cols = 0;
     int wall = 0;
     int value = 0;
+    int first = getc(fp);
+    ungetc(first,fp);
+    if (first == 'M') {return drawBinary(fp);}
     fscanf(fp,"%d",&rows);
     fscanf(fp,"%d",&cols);
 
@@ -177,60 +205,94 @@ void drawMAZE(FILE *fp)
     for (int k = 0; k < cols; ++k)
         printf("----");
     printf("-\n");
+    return 1;
+}
+
+/* Returns 0 if readFile doesn't hold a maze. */
+int solveMAZE(FILE *readFile,FILE *writeFile)
+{
+    return solveMAZEdist(readFile,writeFile,0,0);
 }
 
-void solveMAZE(FILE *readFile,FILE *writeFile)
+/* Solves the maze as solveMAZE does and, if distFile isn't 0, writes the
+   exact distance of every cell from the entrance to it, in binary:
+
+     "MZDS" rows cols varint             (unsigned 32-bit)
+     the distance of every cell, row by row
+
+   If varint is 0 each distance is an unsigned 32-bit integer, with every
+   bit set for cells that can't be reached. Otherwise each row is written
+   as the differences between neighboring distances, starting from 0 and
+   counting unreached cells as -1, each as a zigzag varint (seven bits to
+   a byte, low bits first, the high bit set on all but the last), which
+   takes one byte a cell along a corridor. The same search fills both: it
+   goes on past the exit for the distances alone, and the cells it reaches
+   then are left without values as before. Returns 0 if readFile doesn't
+   hold a maze. */
+int solveMAZEdist(FILE *readFile,FILE *writeFile,FILE *distFile,int varint)
 {
     MAZE *m = readMAZE(readFile);
+    if (m == 0) {return 0;}
     QUEUE *q = newQUEUE();
-    int curRow = 0, curCol = 0;
+    int curRow = m->startRow, curCol = m->startCol;
     CELL *curCell = m->cells[curRow][curCol];
+    uint32_t *dist = 0;
+    if (distFile)
+    {
+        long size = (long)m->rows * m->cols;
+        dist = malloc(sizeof(uint32_t) * size);
+        assert(dist != 0);
+        for (long k = 0; k < size; ++k) {dist[k] = UINT32_MAX;}
+        dist[(long)curRow * m->cols + curCol] = 0;
+    }
     setCELLval(curCell,0);
+    setCELLvisited(curCell);
     enqueue(q,curCell);
 
-    while (curRow != m->rows - 1 || curCol != m->cols - 1)
+    /* Cells are marked visited as they are enqueued, so that a maze with
+       loops can't enqueue a cell more than once. */
+    while (curRow != m->goalRow || curCol != m->goalCol)
     {
         curCell = dequeue(q);
         curRow = getCELLrow(curCell);
         curCol = getCELLcol(curCell);
-        setCELLvisited(curCell);
-
-        // If top cell is eligible to be visited, enqueue and set step val.
-        if (isPathClear(m,curCell,0))
-        {
-            enqueue(q,m->cells[curRow-1][curCol]);
-            setCELLval(m->cells[curRow-1][curCol],
-                (getCELLval(curCell)+1)%10);
-        }
-
-        // If left cell is eligible to be visited, enqueue and set step val.
-        if (isPathClear(m,curCell,1))
-        {
-            enqueue(q,m->cells[curRow][curCol-1]);
-            setCELLval(m->cells[curRow][curCol-1],
-                (getCELLval(curCell)+1)%10);
-        }
 
-        // If right cell is eligible to be visited, enqueue and set step val.
-        if (isPathClear(m,curCell,2))
+        // Enqueue each neighbor eligible to be visited and set step val.
+        for (int wall = 0; wall < 4; ++wall)
         {
-            enqueue(q,m->cells[curRow][curCol+1]);
-            setCELLval(m->cells[curRow][curCol+1],
-                (getCELLval(curCell)+1)%10);
+            if (!isPathClear(m,curCell,wall)) {continue;}
+            CELL *nextCell = m->cells[curRow+RowStep[wall]]
+                                     [curCol+ColStep[wall]];
+            enqueue(q,nextCell);
+            setCELLvisited(nextCell);
+            setCELLval(nextCell,(getCELLval(curCell)+1)%10);
+            if (dist) {setDistance(m,dist,curCell,nextCell);}
         }
-
-        // If bottom cell eligible to be visited, enqueue and set step val.
-        if (isPathClear(m,curCell,3))
+    }
+    while(sizeQUEUE(q))
+    {
+        curCell = dequeue(q);
+        setCELLval(curCell,-1);
+        if (!dist) {continue;}
+        for (int wall = 0; wall < 4; ++wall)
         {
-            enqueue(q,m->cells[curRow+1][curCol]);
-            setCELLval(m->cells[curRow+1][curCol],
-                (getCELLval(curCell)+1)%10);
+            if (!isPathClear(m,curCell,wall)) {continue;}
+            CELL *nextCell = m->cells[getCELLrow(curCell)+RowStep[wall]]
+                                     [getCELLcol(curCell)+ColStep[wall]];
+            enqueue(q,nextCell);
+            setCELLvisited(nextCell);
+            setDistance(m,dist,curCell,nextCell);
         }
     }
-    while(sizeQUEUE(q)) {setCELLval(dequeue(q),-1);}
     freeQUEUE(q);
     writeMAZE(m,writeFile);
+    if (dist)
+    {
+        writeDistances(dist,m->rows,m->cols,varint,distFile);
+        free(dist);
+    }
     freeMAZE(m);
+    return 1;
 }
 
 MAZE *newMAZE(int rows,int cols)
@@ -248,6 +310,18 @@ MAZE *newMAZE(int rows,int cols)
 
     m->rows = rows;
     m->cols = cols;
+    m->startRow = 0;
+    m->startCol = 0;
+    m->goalRow = rows - 1;
+    m->goalCol = cols - 1;
+
+    m->rowMask = malloc(sizeof(unsigned char) * rows);
+    m->colMask = malloc(sizeof(unsigned char) * cols);
+    assert(m->rowMask != 0 && m->colMask != 0);
+    for (int i = 0; i < rows; ++i)
+        m->rowMask[i] = 0x6 | (i > 0 ? 0x1 : 0) | (i < rows - 1 ? 0x8 : 0);
+    for (int j = 0; j < cols; ++j)
+        m->colMask[j] = 0x9 | (j > 0 ? 0x2 : 0) | (j < cols - 1 ? 0x4 : 0);
 
     return m;
 }
@@ -256,21 +330,11 @@ DA *makePosWallsArray(MAZE *m,int curRow,int curCol)
 {
     DA *posWalls = newDA();
 
-    // If top wall is eligible for removal, add to array.
-    if (isWallEligible(m,m->cells[curRow][curCol],0))
-        insertDAback(posWalls,m->cells[curRow-1][curCol]);
-
-    // If left wall is eligible for removal, add to array.
-    if (isWallEligible(m,m->cells[curRow][curCol],1))
-        insertDAback(posWalls,m->cells[curRow][curCol-1]);
-
-    // If right wall is eligible for removal, add to array.
-    if (isWallEligible(m,m->cells[curRow][curCol],2))
-        insertDAback(posWalls,m->cells[curRow][curCol+1]);
-
-    // If bottom wall is eligible for removal, add to array.
-    if (isWallEligible(m,m->cells[curRow][curCol],3))
-        insertDAback(posWalls,m->cells[curRow+1][curCol]);
+    // Add the neighbor behind each wall that is eligible for removal.
+    for (int wall = 0; wall < 4; ++wall)
+        if (isWallEligible(m,m->cells[curRow][curCol],wall))
+            insertDAback(posWalls,m->cells[curRow+RowStep[wall]]
+                                          [curCol+ColStep[wall]]);
 
     return posWalls;
 }
@@ -308,12 +372,20 @@ void writeMAZE(MAZE *m,FILE *fp)
             fprintf(fp,"\n");
         }
     }
+
+    if (m->startRow != 0 || m->startCol != 0 || m->goalRow != m->rows - 1
+        || m->goalCol != m->cols - 1)
+        fprintf(fp,"ends %d %d %d %d\n",m->startRow,m->startCol,
+            m->goalRow,m->goalCol);
 }
 
 MAZE *readMAZE(FILE *fp)
 {
     int rows, cols = 0;
     int wall, value = 0;
+    int first = getc(fp);
+    ungetc(first,fp);
+    if (first == 'M') {return readBinary(fp);}
     fscanf(fp,"%d %d",&rows,&cols);
     MAZE *m = newMAZE(rows,cols);
 
@@ -346,41 +418,246 @@ MAZE *readMAZE(FILE *fp)
             }
         }
     }
+
+    /* Skip any costs, which the maze class doesn't use, and read the
+       entrance and exit if they have been moved. */
+    char word[8];
+    int ignored = 0;
+    while (fscanf(fp,"%7s",word) == 1)
+    {
+        if (strcmp(word,"costs") == 0)
+        {
+            for (long k = 0; k < (long)rows * cols; ++k)
+                fscanf(fp,"%d",&ignored);
+        }
+        else if (strcmp(word,"ends") == 0)
+        {
+            fscanf(fp,"%d %d %d %d",&m->startRow,&m->startCol,
+                &m->goalRow,&m->goalCol);
+            assert(m->startRow >= 0 && m->startRow < rows);
+            assert(m->startCol >= 0 && m->startCol < cols);
+            assert(m->goalRow >= 0 && m->goalRow < rows);
+            assert(m->goalCol >= 0 && m->goalCol < cols);
+        }
+        else {break;}
+    }
     return m;
 }
 
-int isWallEligible(MAZE *m,CELL *c,int wall)
+/* Reads a compressed archive, binary grid, or packed maze through the
+   classes that already read them, and copies its walls, values, and ends.
+   Returns 0 if the file holds none of them. */
+MAZE *readBinary(FILE *fp)
 {
-    assert(wall >= 0 && wall <= 3);
+    char magic[4];
+    if (fread(magic,1,4,fp) != 4) {return 0;}
+    GRID *g = readMagic(fp,magic);
+    if (g == 0) {return 0;}
+    int rows = getGRIDrows(g), cols = getGRIDcols(g);
+    MAZE *m = newMAZE(rows,cols);
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+        {
+            int walls = getGRIDwalls(g,i,j);
+            for (int wall = 0; wall < 4; ++wall)
+                if (!(walls & 1 << wall))
+                    removeCELLwall(m->cells[i][j],wall);
+            setCELLval(m->cells[i][j],getGRIDval(g,i,j));
+        }
+    m->startRow = getGRIDstart(g) / cols;
+    m->startCol = getGRIDstart(g) % cols;
+    m->goalRow = getGRIDgoal(g) / cols;
+    m->goalCol = getGRIDgoal(g) % cols;
+    freeGRID(g);
+    return m;
+}
 
-    if (wall == 0)
+/* Reads the rest of a file whose four byte magic has already been read
+   into a grid, or returns 0 if it isn't a maze. */
+static GRID *readMagic(FILE *fp,const char *magic)
+{
+    if (memcmp(magic,"MZST",4) != 0) {return readGRIDmagic(fp,magic);}
+    SMAZE *s = readSMAZEmagic(fp,magic);
+    if (s == 0) {return 0;}
+    GRID *g = decodeSMAZE(s);
+    freeSMAZE(s);
+    return g;
+}
+
+/* Draws a compressed archive one block of rows at a time, so that only a
+   block is ever held in memory; archives have no values, so every cell is
+   drawn blank. A binary grid or packed maze is read whole and drawn with
+   its values. Returns 0 if the file isn't a maze or an archive is cut
+   short. */
+int drawBinary(FILE *fp)
+{
+    char magic[4];
+    int count = fread(magic,1,4,fp);
+    if (count != 4) {return 0;}
+    if (memcmp(magic,"MZAR",4) != 0)
     {
-        if (getCELLrow(c) == 0) {return 0;}
-        else if (isCELLvisited(m->cells[getCELLrow(c)-1][getCELLcol(c)]))
-            return 0;
-        else {return 1;}
+        GRID *g = readMagic(fp,magic);
+        if (g == 0) {return 0;}
+        drawMAZEgrid(g);
+        freeGRID(g);
+        return 1;
     }
-    else if (wall == 1)
+
+    ARCHIVE *a = openARCHIVEheader(fp);
+    if (a == 0) {return 0;}
+    int rows = getARCHIVErows(a), cols = getARCHIVEcols(a);
+    unsigned char *walls = malloc((long)getARCHIVEblockRows(a) * cols);
+    assert(walls != 0);
+
+    for (int k = 0; k < cols; ++k)
+        printf("----");
+    printf("-\n");
+
+    int row = 0;
+    while ((count = nextARCHIVEblock(a,walls)) > 0)
+        for (int i = 0; i < count; ++i, ++row)
+            drawRow(walls + (long)i * cols,0,cols,row == rows - 1);
+
+    for (int k = 0; k < cols; ++k)
+        printf("----");
+    printf("-\n");
+    free(walls);
+    closeARCHIVE(a);
+    return count == 0;
+}
+
+/* Draws a grid already in memory the way drawMAZE draws a maze file. */
+void drawMAZEgrid(GRID *g)
+{
+    int rows = getGRIDrows(g), cols = getGRIDcols(g);
+    unsigned char *walls = malloc(cols);
+    int *values = malloc(sizeof(int) * cols);
+    assert(walls != 0 && values != 0);
+
+    for (int k = 0; k < cols; ++k)
+        printf("----");
+    printf("-\n");
+
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            walls[j] = getGRIDwalls(g,i,j);
+            values[j] = getGRIDval(g,i,j);
+        }
+        drawRow(walls,values,cols,i == rows - 1);
+    }
+
+    for (int k = 0; k < cols; ++k)
+        printf("----");
+    printf("-\n");
+    free(walls);
+    free(values);
+}
+
+/* Draws only the cells in rows row to row + rows - 1 and columns col to
+   col + cols - 1 of the maze in fp, reading no more of the file than it
+   must: a binary maze is read a window row at a time straight from its
+   place in the file, and an archive from the block holding the first
+   row. rows or cols of 0 or less reach the edge of the maze. If step is
+   more than 1, each step by step block of cells is drawn as one cell, for
+   an overview. A wall between two blocks is open if any passage crosses
+   it, and a block shows the value of the first cell in it that has one.
+   Returns 0 if the file isn't a maze, is cut short, or doesn't hold the
+   first cell of the window. */
+int drawMAZEview(FILE *fp,int row,int col,int rows,int cols,int step)
+{
+    assert(step >= 1);
+    ROWS *r = openROWS(fp);
+    if (r == 0) {return 0;}
+    int mazeRows = getROWSrows(r), mazeCols = getROWScols(r);
+    if (row < 0 || col < 0 || row >= mazeRows || col >= mazeCols ||
+        !seekROWS(r,row))
     {
-        if (getCELLcol(c) == 0) {return 0;}
-        else if (isCELLvisited(m->cells[getCELLrow(c)][getCELLcol(c)-1]))
-            return 0;
-        else {return 1;}
+        closeROWS(r);
+        return 0;
     }
-    else if (wall == 2)
+    if (rows <= 0 || row + rows > mazeRows) {rows = mazeRows - row;}
+    if (cols <= 0 || col + cols > mazeCols) {cols = mazeCols - col;}
+
+    int blockCols = (cols + step - 1) / step;
+    unsigned char *walls = malloc(cols);
+    int *values = malloc(sizeof(int) * cols);
+    unsigned char *blockWalls = malloc(blockCols);
+    int *blockValues = malloc(sizeof(int) * blockCols);
+    assert(walls != 0 && values != 0 && blockWalls != 0 && blockValues != 0);
+
+    int ok = 1;
+    for (int i = 0; ok && i < rows; i += step)
     {
-        if (getCELLcol(c) == m->cols - 1) {return 0;}
-        else if (isCELLvisited(m->cells[getCELLrow(c)][getCELLcol(c)+1]))
-            return 0;
-        else {return 1;}
+        int count = rows - i < step ? rows - i : step;
+        memset(blockWalls,0xF,blockCols);
+        for (int b = 0; b < blockCols; ++b) {blockValues[b] = -1;}
+
+        // Open each block wall that some passage crosses.
+        for (int k = 0; k < count; ++k)
+        {
+            ok = nextROWS(r,walls,values,col,cols);
+            if (!ok) {break;}
+            for (int j = 0; j < cols; ++j)
+            {
+                int b = j / step, open = ~walls[j];
+                if (k == 0) {blockWalls[b] &= ~(open & 0x1);}
+                if (k == count - 1) {blockWalls[b] &= ~(open & 0x8);}
+                if (j % step == 0) {blockWalls[b] &= ~(open & 0x2);}
+                if (j % step == step - 1 || j == cols - 1)
+                    blockWalls[b] &= ~(open & 0x4);
+                if (blockValues[b] == -1) {blockValues[b] = values[j];}
+            }
+        }
+        if (!ok) {break;}
+
+        if (i == 0)
+        {
+            printf("-");
+            for (int b = 0; b < blockCols; ++b)
+                printf(blockWalls[b] & 0x1 ? "----" : "   -");
+            printf("\n");
+        }
+        drawRow(blockWalls,blockValues,blockCols,0);
     }
-    else //wall == 3
+
+    free(walls);
+    free(values);
+    free(blockWalls);
+    free(blockValues);
+    closeROWS(r);
+    return ok;
+}
+
+/* Draws one row of cells from their wall bits, followed by its bottom
+   walls unless it is the last row. Values may be 0 to draw blank cells. */
+void drawRow(unsigned char *walls,int *values,int cols,int last)
+{
+    for (int j = 0; j < cols; ++j)
     {
-        if (getCELLrow(c) == m->rows - 1) {return 0;}
-        else if (isCELLvisited(m->cells[getCELLrow(c)+1][getCELLcol(c)]))
-            return 0;
-        else {return 1;}
+        printf(walls[j] & 0x2 ? "|" : " ");
+        if (values && values[j] > -1) {printf(" %d ",values[j]);}
+        else {printf("   ");}
     }
+    printf(walls[cols-1] & 0x4 ? "|\n" : " \n");
+    if (last) {return;}
+    printf("-");
+    for (int j = 0; j < cols; ++j)
+        printf(walls[j] & 0x8 ? "----" : "   -");
+    printf("\n");
+}
+
+int isWallEligible(MAZE *m,CELL *c,int wall)
+{
+    assert(wall >= 0 && wall <= 3);
+
+    /* If the wall is an edge of the maze or the cell behind it is already
+       visited, return 0. */
+    int row = getCELLrow(c);
+    int col = getCELLcol(c);
+    if (!(m->rowMask[row] & m->colMask[col] & (1 << wall))) {return 0;}
+    return !isCELLvisited(m->cells[row+RowStep[wall]][col+ColStep[wall]]);
 }
 
 int isPathClear(MAZE *m,CELL *c,int wall)
@@ -390,34 +667,8 @@ int isPathClear(MAZE *m,CELL *c,int wall)
        in to so return 1.*/
     assert(wall >= 0 && wall <= 3);
 
-    if (wall == 0)
-    {
-        if (getCELLrow(c) == 0 || getCELLwall(c,0)) {return 0;}
-        if (isCELLvisited(m->cells[getCELLrow(c)-1][getCELLcol(c)]))
-            return 0;
-        else {return 1;}
-    }
-    else if (wall == 1)
-    {
-        if (getCELLcol(c) == 0 || getCELLwall(c,1)) {return 0;}
-        if (isCELLvisited(m->cells[getCELLrow(c)][getCELLcol(c)-1]))
-            return 0;
-        else {return 1;}
-    }
-    else if (wall == 2)
-    {
-        if (getCELLcol(c) == m->cols - 1 || getCELLwall(c,2)) {return 0;}
-        if (isCELLvisited(m->cells[getCELLrow(c)][getCELLcol(c)+1]))
-            return 0;
-        else {return 1;}
-    }
-    else // wall == 3
-    {
-        if (getCELLrow(c) == m->rows - 1 || getCELLwall(c,3)) {return 0;}
-        if (isCELLvisited(m->cells[getCELLrow(c)+1][getCELLcol(c)]))
-            return 0;
-        else {return 1;}
-    }
+    if (getCELLwall(c,wall)) {return 0;}
+    return isWallEligible(m,c,wall);
 }
 
 void freeMAZE(MAZE *m)
@@ -430,5 +681,46 @@ void freeMAZE(MAZE *m)
     }
 
     free(m->cells);
+    free(m->rowMask);
+    free(m->colMask);
     free(m);
 }
+
+static void setDistance(MAZE *m,uint32_t *dist,CELL *from,CELL *to)
+{
+    long fromIndex = (long)getCELLrow(from) * m->cols + getCELLcol(from);
+    long toIndex = (long)getCELLrow(to) * m->cols + getCELLcol(to);
+    dist[toIndex] = dist[fromIndex] + 1;
+}
+
+static void writeDistances(uint32_t *dist,int rows,int cols,int varint,
+                           FILE *fp)
+{
+    uint32_t header[3] = {rows,cols,varint != 0};
+    fwrite("MZDS",1,4,fp);
+    fwrite(header,sizeof(uint32_t),3,fp);
+    if (!varint)
+    {
+        fwrite(dist,sizeof(uint32_t),(long)rows * cols,fp);
+        return;
+    }
+
+    for (int i = 0; i < rows; ++i)
+    {
+        int64_t prev = 0;
+        for (int j = 0; j < cols; ++j)
+        {
+            uint32_t d = dist[(long)i * cols + j];
+            int64_t value = d == UINT32_MAX ? -1 : (int64_t)d;
+            int64_t delta = value - prev;
+            uint64_t n = (uint64_t)delta << 1 ^ (uint64_t)(delta >> 63);
+            prev = value;
+            while (n >= 0x80)
+            {
+                putc((n & 0x7F) | 0x80,fp);
+                n >>= 7;
+            }
+            putc(n,fp);
+        }
+    }
+}
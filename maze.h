@@ -3,11 +3,17 @@
 
 #include <stdio.h>
 #include "cell.h"
+#include "grid.h"
 
 typedef struct maze MAZE;
 
 extern void createMAZE(int rows,int cols,int randSeed,FILE *fp);
-extern void solveMAZE(FILE *readFile,FILE *writeFILE);
-extern void drawMAZE(FILE *fp);
+extern int  solveMAZE(FILE *readFile,FILE *writeFILE);
+extern int  solveMAZEdist(FILE *readFile,FILE *writeFile,FILE *distFile,
+                          int varint);
+extern int  drawMAZE(FILE *fp);
+extern void drawMAZEgrid(GRID *g);
+extern int  drawMAZEview(FILE *fp,int row,int col,int rows,int cols,
+                         int step);
 
 #endif
@@ -0,0 +1,417 @@
+/***************************************************************************
+ * This n-dimensional maze class generalizes the grid class to mazes with  *
+ * one to four dimensions, such as a stack of two dimensional levels with  *
+ * passages up and down between them. Cells are stored in one flat array,  *
+ * the last axis varying fastest, and each cell is a byte with one bit per *
+ * wall: bit 2a is the wall towards the lower neighbor on axis a and bit   *
+ * 2a+1 the wall towards the higher one, so the opposite of wall w is w^1. *
+ * Stepping through wall w adds offset[w] to the cell index.               *
+ *                                                                         *
+ * Generation (a randomized depth first search) and solving (a breadth     *
+ * first search) are written once in terms of these offsets, in the       *
+ * NMAZE_KERNELS macro, which is expanded once per number of dimensions.   *
+ * The number of walls is then a constant in each expansion, so the loops  *
+ * over walls are unrolled and two dimensional mazes pay nothing for the   *
+ * generality.                                                             *
+ *                                                                         *
+ * The entrance is the lower wall of the first cell on the last axis and   *
+ * the exit the higher wall of the last cell; neither is stored. Mazes are *
+ * written as text, the line "nmaze D E1 ... ED" followed by each cell's   *
+ * walls as two hex digits, one line per run along the last axis. They     *
+ * can also be written in binary as the four bytes "MZND", D and the       *
+ * extents as unsigned 32-bit integers in the byte order of the machine,   *
+ * and then one byte per cell. readNMAZE reads either.                     *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "nmaze.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+// Necissary for random() and srandom() to work.
+long int random(void);
+void srandom(unsigned int seed);
+
+struct nmaze
+{
+    int dims;
+    int extent[NMAZE_MAXDIMS];
+    long offset[2*NMAZE_MAXDIMS];
+    long size;
+    /* Bit w of a cell is set while wall w of that cell is standing. */
+    unsigned char *cells;
+};
+
+static NMAZE *readBINARY(FILE *fp);
+static NMAZE *readTEXT(FILE *fp);
+static void   closeEdges(NMAZE *m);
+
+/* Defines carveD, which removes walls from a maze whose walls are all
+   standing until every cell is reached, and searchD, which sets prev of
+   every cell reached from the first cell to the cell it was reached from
+   (the first cell is its own), stopping at the last cell. An unreached
+   cell has all its walls standing, so the depth first search needs no
+   visited flags; its stack holds at most one entry per cell. */
+#define NMAZE_KERNELS(D)                                                    \
+static void carve##D(NMAZE *m,long *stack)                                  \
+{                                                                           \
+    const int closed = (1 << (2*D)) - 1;                                    \
+    long top = 0;                                                           \
+    stack[top++] = 0;                                                       \
+    while (top > 0)                                                         \
+    {                                                                       \
+        long cell = stack[top-1];                                           \
+        long rest = cell;                                                   \
+        int choices[2*D];                                                   \
+        int count = 0;                                                      \
+        for (int axis = D-1; axis >= 0; --axis)                             \
+        {                                                                   \
+            int coord = rest % m->extent[axis];                             \
+            rest /= m->extent[axis];                                        \
+            if (coord > 0 && m->cells[cell + m->offset[2*axis]] == closed)  \
+                choices[count++] = 2*axis;                                  \
+            if (coord < m->extent[axis] - 1                                 \
+                && m->cells[cell + m->offset[2*axis+1]] == closed)          \
+                choices[count++] = 2*axis + 1;                              \
+        }                                                                   \
+        if (count == 0) {--top; continue;}                                  \
+                                                                            \
+        int wall = choices[random() % count];                               \
+        long next = cell + m->offset[wall];                                 \
+        m->cells[cell] &= ~(1 << wall);                                     \
+        m->cells[next] &= ~(1 << (wall ^ 1));                               \
+        stack[top++] = next;                                                \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+static void search##D(NMAZE *m,long *prev,long *queue)                      \
+{                                                                           \
+    long goal = m->size - 1;                                                \
+    long head = 0, tail = 0;                                                \
+    for (long i = 0; i < m->size; ++i) {prev[i] = -1;}                      \
+    prev[0] = 0;                                                            \
+    queue[tail++] = 0;                                                      \
+    while (head < tail)                                                     \
+    {                                                                       \
+        long cell = queue[head++];                                          \
+        if (cell == goal) {break;}                                          \
+        int walls = m->cells[cell];                                         \
+        for (int wall = 0; wall < 2*D; ++wall)                              \
+        {                                                                   \
+            if (walls & (1 << wall)) {continue;}                            \
+            long next = cell + m->offset[wall];                             \
+            if (prev[next] == -1)                                           \
+            {                                                               \
+                prev[next] = cell;                                          \
+                queue[tail++] = next;                                       \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+}
+
+NMAZE_KERNELS(1)
+NMAZE_KERNELS(2)
+NMAZE_KERNELS(3)
+NMAZE_KERNELS(4)
+
+static void (*Carve[NMAZE_MAXDIMS+1])(NMAZE *,long *) =
+    {0,carve1,carve2,carve3,carve4};
+static void (*Search[NMAZE_MAXDIMS+1])(NMAZE *,long *,long *) =
+    {0,search1,search2,search3,search4};
+
+NMAZE *newNMAZE(int dims,const int *extents)
+{
+    assert(dims >= 1 && dims <= NMAZE_MAXDIMS);
+
+    NMAZE *m = (NMAZE *)malloc(sizeof(NMAZE));
+    assert(m != 0);
+
+    m->dims = dims;
+    m->size = 1;
+    for (int axis = dims - 1; axis >= 0; --axis)
+    {
+        assert(extents[axis] > 0);
+        m->extent[axis] = extents[axis];
+        m->offset[2*axis] = -m->size;
+        m->offset[2*axis+1] = m->size;
+        m->size *= extents[axis];
+    }
+
+    m->cells = malloc(sizeof(unsigned char) * m->size);
+    assert(m->cells != 0);
+    memset(m->cells,(1 << (2*dims)) - 1,m->size);
+
+    return m;
+}
+
+NMAZE *generateNMAZE(int dims,const int *extents,int randSeed)
+{
+    srandom(randSeed);
+    NMAZE *m = newNMAZE(dims,extents);
+
+    long *stack = malloc(sizeof(long) * m->size);
+    assert(stack != 0);
+    Carve[dims](m,stack);
+    free(stack);
+
+    return m;
+}
+
+int  getNMAZEdims(NMAZE *m) {return m->dims;}
+int  getNMAZEextent(NMAZE *m,int axis) {return m->extent[axis];}
+long sizeNMAZE(NMAZE *m) {return m->size;}
+
+long cellNMAZE(NMAZE *m,const int *coords)
+{
+    long cell = 0;
+    for (int axis = 0; axis < m->dims; ++axis)
+    {
+        assert(coords[axis] >= 0 && coords[axis] < m->extent[axis]);
+        cell = cell * m->extent[axis] + coords[axis];
+    }
+    return cell;
+}
+
+void coordsNMAZE(NMAZE *m,long cell,int *coords)
+{
+    assert(cell >= 0 && cell < m->size);
+    for (int axis = m->dims - 1; axis >= 0; --axis)
+    {
+        coords[axis] = cell % m->extent[axis];
+        cell /= m->extent[axis];
+    }
+}
+
+int getNMAZEwalls(NMAZE *m,long cell) {return m->cells[cell];}
+
+/* Returns the cell through the given wall, or -1 if there is none. */
+long neighborNMAZE(NMAZE *m,long cell,int wall)
+{
+    assert(wall >= 0 && wall < 2 * m->dims);
+    int coords[NMAZE_MAXDIMS];
+    coordsNMAZE(m,cell,coords);
+    int coord = coords[wall/2] + (wall & 1 ? 1 : -1);
+    if (coord < 0 || coord >= m->extent[wall/2]) {return -1;}
+    return cell + m->offset[wall];
+}
+
+/* Removes a wall from a cell and the matching wall from its neighbor. */
+void removeNMAZEwall(NMAZE *m,long cell,int wall)
+{
+    long next = neighborNMAZE(m,cell,wall);
+    if (next == -1) {return;}
+
+    m->cells[cell] &= ~(1 << wall);
+    m->cells[next] &= ~(1 << (wall ^ 1));
+}
+
+/* Fills path with the cells from the entrance to the exit and returns how
+   many there are, or returns -1 if the exit can't be reached. */
+long pathNMAZE(NMAZE *m,long *path)
+{
+    long *prev = malloc(sizeof(long) * m->size);
+    long *queue = malloc(sizeof(long) * m->size);
+    assert(prev != 0 && queue != 0);
+    Search[m->dims](m,prev,queue);
+
+    long count = -1;
+    long cell = m->size - 1;
+    if (prev[cell] != -1)
+    {
+        /* Walk back to the entrance, then reverse. */
+        count = 0;
+        path[count++] = cell;
+        while (cell != 0)
+        {
+            cell = prev[cell];
+            path[count++] = cell;
+        }
+        for (long i = 0; i < count / 2; ++i)
+        {
+            long swap = path[i];
+            path[i] = path[count-1-i];
+            path[count-1-i] = swap;
+        }
+    }
+
+    free(prev);
+    free(queue);
+    return count;
+}
+
+void writeNMAZE(NMAZE *m,FILE *fp)
+{
+    fprintf(fp,"nmaze %d",m->dims);
+    for (int axis = 0; axis < m->dims; ++axis)
+        fprintf(fp," %d",m->extent[axis]);
+    fprintf(fp,"\n");
+
+    int run = m->extent[m->dims-1];
+    long plane = m->dims > 1 ? (long)run * m->extent[m->dims-2] : m->size;
+    for (long i = 0; i < m->size; ++i)
+    {
+        fprintf(fp,"%02x",m->cells[i]);
+        if ((i + 1) % run) {fprintf(fp," ");}
+        else {fprintf(fp,"\n");}
+        if ((i + 1) % plane == 0 && i + 1 < m->size) {fprintf(fp,"\n");}
+    }
+}
+
+void writeNMAZEbinary(NMAZE *m,FILE *fp)
+{
+    uint32_t header[1+NMAZE_MAXDIMS];
+    header[0] = m->dims;
+    for (int axis = 0; axis < m->dims; ++axis)
+        header[1+axis] = m->extent[axis];
+
+    fwrite("MZND",1,4,fp);
+    fwrite(header,sizeof(uint32_t),1 + m->dims,fp);
+    fwrite(m->cells,1,m->size,fp);
+}
+
+/* Reads a maze in either format, or returns 0 if there isn't one. */
+NMAZE *readNMAZE(FILE *fp)
+{
+    int c = getc(fp);
+    if (c == EOF) {return 0;}
+    ungetc(c,fp);
+    if (c != 'M') {return readTEXT(fp);}
+    char magic[4];
+    if (fread(magic,1,4,fp) != 4) {return 0;}
+    return readNMAZEmagic(fp,magic);
+}
+
+/* Reads the rest of a binary maze whose four byte magic has already been
+   read, like readGRIDmagic. Returns 0 for any other magic. */
+NMAZE *readNMAZEmagic(FILE *fp,const char *magic)
+{
+    if (memcmp(magic,"MZND",4) != 0) {return 0;}
+    return readBINARY(fp);
+}
+
+void freeNMAZE(NMAZE *m)
+{
+    free(m->cells);
+    free(m);
+}
+
+void createNMAZE(int dims,const int *extents,int randSeed,FILE *fp)
+{
+    NMAZE *m = generateNMAZE(dims,extents,randSeed);
+    writeNMAZE(m,fp);
+    freeNMAZE(m);
+}
+
+/* Writes the maze followed by "path N" and the coordinates of the N cells
+   on the path, one cell per line. Returns the number of steps, or -1. */
+long solveNMAZE(FILE *readFile,FILE *writeFile)
+{
+    NMAZE *m = readNMAZE(readFile);
+    if (m == 0) {return -1;}
+
+    long *path = malloc(sizeof(long) * m->size);
+    assert(path != 0);
+    long count = pathNMAZE(m,path);
+
+    writeNMAZE(m,writeFile);
+    fprintf(writeFile,"path %ld\n",count > 0 ? count : 0);
+    for (long i = 0; i < count; ++i)
+    {
+        int coords[NMAZE_MAXDIMS];
+        coordsNMAZE(m,path[i],coords);
+        for (int axis = 0; axis < m->dims; ++axis)
+            fprintf(writeFile,axis ? " %d" : "%d",coords[axis]);
+        fprintf(writeFile,"\n");
+    }
+
+    free(path);
+    freeNMAZE(m);
+    return count > 0 ? count - 1 : -1;
+}
+
+/* Rewrites a text maze in binary or a binary maze as text. Returns 0 if
+   there was no maze to read. */
+int convertNMAZE(FILE *readFile,FILE *writeFile)
+{
+    int c = getc(readFile);
+    if (c == EOF) {return 0;}
+    ungetc(c,readFile);
+
+    NMAZE *m = readNMAZE(readFile);
+    if (m == 0) {return 0;}
+    if (c == 'M') {writeNMAZE(m,writeFile);}
+    else {writeNMAZEbinary(m,writeFile);}
+    freeNMAZE(m);
+    return 1;
+}
+
+static NMAZE *readBINARY(FILE *fp)
+{
+    uint32_t dims;
+    uint32_t header[NMAZE_MAXDIMS];
+    int extents[NMAZE_MAXDIMS];
+
+    if (fread(&dims,sizeof(uint32_t),1,fp) != 1) {return 0;}
+    if (dims < 1 || dims > NMAZE_MAXDIMS) {return 0;}
+    if (fread(header,sizeof(uint32_t),dims,fp) != dims) {return 0;}
+    for (uint32_t axis = 0; axis < dims; ++axis)
+    {
+        if (header[axis] < 1) {return 0;}
+        extents[axis] = header[axis];
+    }
+
+    NMAZE *m = newNMAZE(dims,extents);
+    if (fread(m->cells,1,m->size,fp) != (size_t)m->size)
+    {
+        freeNMAZE(m);
+        return 0;
+    }
+    closeEdges(m);
+    return m;
+}
+
+static NMAZE *readTEXT(FILE *fp)
+{
+    char word[8];
+    int dims = 0;
+    int extents[NMAZE_MAXDIMS];
+
+    if (fscanf(fp,"%7s %d",word,&dims) != 2) {return 0;}
+    if (strcmp(word,"nmaze") != 0) {return 0;}
+    if (dims < 1 || dims > NMAZE_MAXDIMS) {return 0;}
+    for (int axis = 0; axis < dims; ++axis)
+        if (fscanf(fp,"%d",&extents[axis]) != 1 || extents[axis] < 1)
+            return 0;
+
+    NMAZE *m = newNMAZE(dims,extents);
+    unsigned int walls = 0;
+    for (long i = 0; i < m->size; ++i)
+    {
+        if (fscanf(fp,"%x",&walls) != 1) {break;}
+        m->cells[i] = walls;
+    }
+    closeEdges(m);
+    return m;
+}
+
+/* Stands every wall on the outside of the maze. The kernels step through
+   any open wall without checking for an edge, so a file that opens one
+   would send them outside the cells. */
+static void closeEdges(NMAZE *m)
+{
+    for (int axis = 0; axis < m->dims; ++axis)
+    {
+        long stride = m->offset[2*axis+1];
+        int extent = m->extent[axis];
+        for (long i = 0; i < m->size; ++i)
+        {
+            int coord = i / stride % extent;
+            if (coord == 0) {m->cells[i] |= 1 << (2*axis);}
+            if (coord == extent - 1) {m->cells[i] |= 1 << (2*axis + 1);}
+        }
+    }
+}
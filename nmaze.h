@@ -0,0 +1,31 @@
+#ifndef __NMAZE_INCLUDED__
+#define __NMAZE_INCLUDED__
+
+#include <stdio.h>
+
+#define NMAZE_MAXDIMS 4
+
+typedef struct nmaze NMAZE;
+
+extern NMAZE *newNMAZE(int dims,const int *extents);
+extern NMAZE *generateNMAZE(int dims,const int *extents,int randSeed);
+extern int    getNMAZEdims(NMAZE *m);
+extern int    getNMAZEextent(NMAZE *m,int axis);
+extern long   sizeNMAZE(NMAZE *m);
+extern long   cellNMAZE(NMAZE *m,const int *coords);
+extern void   coordsNMAZE(NMAZE *m,long cell,int *coords);
+extern int    getNMAZEwalls(NMAZE *m,long cell);
+extern long   neighborNMAZE(NMAZE *m,long cell,int wall);
+extern void   removeNMAZEwall(NMAZE *m,long cell,int wall);
+extern long   pathNMAZE(NMAZE *m,long *path);
+extern void   writeNMAZE(NMAZE *m,FILE *fp);
+extern void   writeNMAZEbinary(NMAZE *m,FILE *fp);
+extern NMAZE *readNMAZE(FILE *fp);
+extern NMAZE *readNMAZEmagic(FILE *fp,const char *magic);
+extern void   freeNMAZE(NMAZE *m);
+
+extern void createNMAZE(int dims,const int *extents,int randSeed,FILE *fp);
+extern long solveNMAZE(FILE *readFile,FILE *writeFile);
+extern int  convertNMAZE(FILE *readFile,FILE *writeFile);
+
+#endif
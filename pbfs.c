@@ -0,0 +1,269 @@
+/***************************************************************************
+ * This module is a breadth first search run on several threads at once,   *
+ * for mazes too big for one core. The search goes a level at a time: all  *
+ * the cells at distance d are expanded before any at distance d+1, and    *
+ * the threads wait for each other between levels.                         *
+ *                                                                         *
+ * Each thread keeps its own frontier, the cells it found on the last      *
+ * level, and hands them out in chunks through a counter that every thread *
+ * can advance. A thread first works through its own frontier and then     *
+ * steals chunks from the others until every frontier is used up, so no    *
+ * thread sits idle while another still has work. A cell is claimed by     *
+ * swapping its distance from unreached to d+1 with compare and swap, so   *
+ * only one thread ever adds it to a frontier.                             *
+ *                                                                         *
+ * Every cell is given its distance on the level it is first reached, so   *
+ * the distances are exactly those found by the single threaded search in  *
+ * floodGRID, whatever order the threads run in.                           *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include "pbfs.h"
+#include "flood.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <limits.h>
+#include <assert.h>
+
+#define PBFS_CHUNK 256
+#define PBFS_MAX_THREADS 256
+
+typedef struct frontier
+{
+    int *cells;
+    long size;
+    long capacity;
+    /* Index of the next chunk to hand out; advanced by any thread. */
+    long head;
+} FRONTIER;
+
+typedef struct pbfs
+{
+    GRID *g;
+    int rows;
+    int cols;
+    int threads;
+    unsigned int *dist;
+    unsigned int level;
+    int done;
+    long reached;
+    FRONTIER *current;
+    FRONTIER *next;
+    pthread_barrier_t barrier;
+} PBFS;
+
+typedef struct worker
+{
+    PBFS *p;
+    int id;
+} WORKER;
+
+static void *runWorker(void *arg);
+static void expandChunk(PBFS *p,FRONTIER *from,long first,FRONTIER *to);
+static void pushFrontier(FRONTIER *f,int cell);
+
+static int RowStep[4] = {-1,0,0,1};
+static int ColStep[4] = {0,-1,1,0};
+
+/* Returns the number of cores online, which is the default number of
+   threads. */
+int threadsPBFS(void)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) {return 1;}
+    if (cores > PBFS_MAX_THREADS) {return PBFS_MAX_THREADS;}
+    return cores;
+}
+
+/* Fills dist with the number of steps from source to every cell, or
+   FLOOD_UNREACHED, and returns the number of cells reached. */
+long pbfsGRID(GRID *g,long source,int threads,unsigned int *dist)
+{
+    if (threads < 1) {threads = threadsPBFS();}
+    if (threads > PBFS_MAX_THREADS) {threads = PBFS_MAX_THREADS;}
+    PBFS p;
+    p.g = g;
+    p.rows = getGRIDrows(g);
+    p.cols = getGRIDcols(g);
+    /* Frontier cells are stored as ints to halve their memory traffic. */
+    assert((long)p.rows * p.cols <= INT_MAX);
+    p.threads = threads;
+    p.dist = dist;
+    p.level = 0;
+    p.done = 0;
+    p.reached = 1;
+    p.current = calloc(threads,sizeof(FRONTIER));
+    p.next = calloc(threads,sizeof(FRONTIER));
+    assert(p.current != 0 && p.next != 0);
+    pthread_barrier_init(&p.barrier,0,threads);
+
+    long size = (long)p.rows * p.cols;
+    for (long i = 0; i < size; ++i) {dist[i] = FLOOD_UNREACHED;}
+    dist[source] = 0;
+    pushFrontier(&p.current[0],source);
+
+    WORKER *workers = malloc(sizeof(WORKER) * threads);
+    pthread_t *ids = malloc(sizeof(pthread_t) * threads);
+    assert(workers != 0 && ids != 0);
+    for (int t = 0; t < threads; ++t)
+    {
+        workers[t].p = &p;
+        workers[t].id = t;
+    }
+    for (int t = 1; t < threads; ++t)
+    {
+        int err = pthread_create(&ids[t],0,runWorker,&workers[t]);
+        assert(err == 0);
+        (void)err;
+    }
+    runWorker(&workers[0]);
+    for (int t = 1; t < threads; ++t) {pthread_join(ids[t],0);}
+
+    for (int t = 0; t < threads; ++t)
+    {
+        free(p.current[t].cells);
+        free(p.next[t].cells);
+    }
+    free(p.current);
+    free(p.next);
+    free(workers);
+    free(ids);
+    pthread_barrier_destroy(&p.barrier);
+    return p.reached;
+}
+
+/* Leaves the values of the cells on the path set to their step number mod
+   10 and all other values set to -1, and returns the number of steps, or
+   -1 if the maze can't be read or the exit can't be reached. */
+long solvePBFS(FILE *readFile,FILE *writeFile,int threads)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return -1;}
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    long size = (long)rows * cols;
+    unsigned int *dist = malloc(sizeof(unsigned int) * size);
+    assert(dist != 0);
+
+    long start = getGRIDstart(g), goal = getGRIDgoal(g);
+    pbfsGRID(g,start,threads,dist);
+
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            setGRIDval(g,i,j,-1);
+
+    /* Walk back from the exit to any neighbor one step closer. */
+    long steps = dist[goal] == FLOOD_UNREACHED ? -1 : (long)dist[goal];
+    long cell = goal;
+    while (steps >= 0)
+    {
+        int row = cell / cols, col = cell % cols;
+        setGRIDval(g,row,col,dist[cell] % 10);
+        if (cell == start) {break;}
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (getGRIDwall(g,row,col,wall)) {continue;}
+            int r = row + RowStep[wall], c = col + ColStep[wall];
+            if (r < 0 || r >= rows || c < 0 || c >= cols) {continue;}
+            if (dist[(long)r * cols + c] == dist[cell] - 1)
+            {
+                cell = (long)r * cols + c;
+                break;
+            }
+        }
+    }
+
+    writeGRID(g,writeFile);
+    free(dist);
+    freeGRID(g);
+    return steps;
+}
+
+static void *runWorker(void *arg)
+{
+    WORKER *w = arg;
+    PBFS *p = w->p;
+
+    while (1)
+    {
+        /* Own frontier first, then steal from the others in turn. */
+        for (int k = 0; k < p->threads; ++k)
+        {
+            FRONTIER *from = &p->current[(w->id + k) % p->threads];
+            while (1)
+            {
+                long first = __atomic_fetch_add(&from->head,PBFS_CHUNK,
+                    __ATOMIC_RELAXED);
+                if (first >= from->size) {break;}
+                expandChunk(p,from,first,&p->next[w->id]);
+            }
+        }
+
+        /* One thread swaps the frontiers while the others wait. */
+        if (pthread_barrier_wait(&p->barrier) ==
+            PTHREAD_BARRIER_SERIAL_THREAD)
+        {
+            long total = 0;
+            for (int t = 0; t < p->threads; ++t)
+            {
+                FRONTIER spent = p->current[t];
+                p->current[t] = p->next[t];
+                p->current[t].head = 0;
+                p->next[t] = spent;
+                p->next[t].size = 0;
+                total += p->current[t].size;
+            }
+            p->reached += total;
+            p->done = total == 0;
+            ++p->level;
+        }
+        pthread_barrier_wait(&p->barrier);
+        if (p->done) {break;}
+    }
+    return 0;
+}
+
+static void expandChunk(PBFS *p,FRONTIER *from,long first,FRONTIER *to)
+{
+    long last = first + PBFS_CHUNK;
+    if (last > from->size) {last = from->size;}
+    unsigned int step = p->level + 1;
+
+    for (long i = first; i < last; ++i)
+    {
+        int cell = from->cells[i];
+        int row = cell / p->cols, col = cell % p->cols;
+        int walls = getGRIDwalls(p->g,row,col);
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (walls & (1 << wall)) {continue;}
+            int r = row + RowStep[wall], c = col + ColStep[wall];
+            if (r < 0 || r >= p->rows || c < 0 || c >= p->cols) {continue;}
+            long n = (long)r * p->cols + c;
+
+            /* A plain load first skips the swap for cells already taken. */
+            unsigned int seen = __atomic_load_n(&p->dist[n],__ATOMIC_RELAXED);
+            if (seen != FLOOD_UNREACHED) {continue;}
+            if (__atomic_compare_exchange_n(&p->dist[n],&seen,step,0,
+                __ATOMIC_RELAXED,__ATOMIC_RELAXED))
+                pushFrontier(to,n);
+        }
+    }
+}
+
+static void pushFrontier(FRONTIER *f,int cell)
+{
+    if (f->size == f->capacity)
+    {
+        f->capacity = f->capacity ? f->capacity * 2 : 1024;
+        f->cells = realloc(f->cells,sizeof(int) * f->capacity);
+        assert(f->cells != 0);
+    }
+    f->cells[f->size++] = cell;
+}
@@ -0,0 +1,11 @@
+#ifndef __PBFS_INCLUDED__
+#define __PBFS_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+extern int  threadsPBFS(void);
+extern long pbfsGRID(GRID *g,long source,int threads,unsigned int *dist);
+extern long solvePBFS(FILE *readFile,FILE *writeFile,int threads);
+
+#endif
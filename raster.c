@@ -0,0 +1,237 @@
+/***************************************************************************
+ * This module draws a maze as an image instead of as text, so that mazes  *
+ * far larger than a terminal can be looked at. The image is a binary PBM  *
+ * (black and white) or PGM (gray) file, written one line of pixels at a   *
+ * time as the maze is read one row at a time, so memory grows with the    *
+ * width of the maze and not its size. Text mazes are read row by row,     *
+ * archives block by block, and binary grids by seeking to each row.       *
+ *                                                                         *
+ * Each cell is a square of pixels, and neighboring cells share the line   *
+ * of pixels between them, which is black where there is a wall. Corners   *
+ * are always black. In a PGM image, the path in a route file written by  *
+ * -R or -M is laid over the maze in gray, both its cells and the open     *
+ * walls it passes through. A PBM image has no gray, so it shows only the  *
+ * walls.                                                                  *
+ *                                                                         *
+ * The values in a solved maze are no guide to the path, since the         *
+ * breadth first solver leaves a value in every cell it reached. The route *
+ * is read into two sorted lists instead, one of the cells on it and one   *
+ * of the walls it crosses, and each row takes its share from the front   *
+ * of them as it is drawn. This is the one part that grows with the length *
+ * of the path, at two longs a step. The walls it crosses are checked      *
+ * against the maze as the rows go by.                                     *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "raster.h"
+#include "rows.h"
+#include "route.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define BLACK 0
+#define GRAY  128
+#define WHITE 255
+
+static long readPath(FILE *fp,int rows,int cols,long **cells,
+                     long **crossings);
+static void drawRow(int cols,unsigned char *walls,unsigned char *marks,
+                    int pixels,int lines,int gray,unsigned char *line,
+                    FILE *fp);
+static int  compareLongs(const void *a,const void *b);
+static void putLine(unsigned char *pixels,long width,int gray,
+                    unsigned char *bits,FILE *fp);
+
+/* Draws the maze in readFile as a PGM image if gray is set, or else as a
+   PBM image, with each cell pixels wide. If routeFile isn't 0, a PGM image
+   shows the path in it. Returns 1, 0 if readFile isn't a maze or is cut
+   short, or -1 if routeFile doesn't hold a path through the maze. */
+int rasterMAZE(FILE *readFile,FILE *routeFile,FILE *writeFile,int pixels,
+               int gray)
+{
+    assert(pixels >= 2);
+    ROWS *r = openROWS(readFile);
+    if (r == 0) {return 0;}
+    int rows = getROWSrows(r), cols = getROWScols(r);
+    long *cells = 0, *crossings = 0, count = 0;
+    if (routeFile && gray)
+    {
+        count = readPath(routeFile,rows,cols,&cells,&crossings);
+        if (count < 0)
+        {
+            closeROWS(r);
+            return -1;
+        }
+    }
+    long width = (long)cols * pixels + 1, height = (long)rows * pixels + 1;
+    fprintf(writeFile,"%s\n%ld %ld\n",gray ? "P5" : "P4",width,height);
+    if (gray) {fprintf(writeFile,"255\n");}
+
+    /* Bit 0 of a mark is a cell on the path, bit 1 its top wall crossed,
+       and bit 2 its left wall crossed, the same bits as the walls. */
+    unsigned char *walls = malloc(cols);
+    unsigned char *marks = calloc(cols,1);
+    unsigned char *line = malloc(width * 2 + (width + 7) / 8);
+    assert(walls != 0 && marks != 0 && line != 0);
+
+    int ok = 1;
+    long nextCell = 0, nextCrossing = 0;
+    for (int i = 0; ok && i < rows; ++i)
+    {
+        ok = nextROWS(r,walls,0,0,cols);
+        if (!ok) {break;}
+
+        long rowEnd = (long)(i + 1) * cols;
+        memset(marks,0,cols);
+        for (; nextCell < count && cells[nextCell] < rowEnd; ++nextCell)
+            marks[cells[nextCell] % cols] |= 0x1;
+        for (; nextCrossing < count - 1 &&
+            crossings[nextCrossing] / 2 < rowEnd; ++nextCrossing)
+        {
+            long cell = crossings[nextCrossing] / 2;
+            int wall = 1 << crossings[nextCrossing] % 2;
+            if (walls[cell % cols] & wall) {ok = -1;}
+            marks[cell % cols] |= wall << 1;
+        }
+        if (ok < 0) {break;}
+        drawRow(cols,walls,marks,pixels,pixels - 1,gray,line,writeFile);
+    }
+
+    /* The bottom outer walls are drawn as the top of one more row, whose
+       top walls are the bottom walls of the last. */
+    if (ok > 0)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            walls[j] = walls[j] >> 3 & 0x1;
+            marks[j] = 0;
+        }
+        drawRow(cols,walls,marks,pixels,0,gray,line,writeFile);
+    }
+
+    free(cells);
+    free(crossings);
+    free(walls);
+    free(marks);
+    free(line);
+    closeROWS(r);
+    return ok;
+}
+
+/* Reads the route into a sorted list of the cells on it and a sorted list
+   of the walls it crosses, each as cell * 2 plus 0 for the cell's top wall
+   or 1 for its left wall. Returns the number of cells, one more than the
+   number of walls, or -1 if the route leaves the maze or misses its end. */
+static long readPath(FILE *fp,int rows,int cols,long **cells,
+                     long **crossings)
+{
+    static const long RowStep[4] = {-1,0,0,1};
+    static const long ColStep[4] = {0,-1,1,0};
+    long start, goal;
+    unsigned char *moves;
+    long length = readROUTE(fp,rows,cols,&start,&goal,&moves);
+    if (length < 0) {return -1;}
+
+    *cells = malloc(sizeof(long) * (length + 1));
+    *crossings = malloc(sizeof(long) * (length + 1));
+    assert(*cells != 0 && *crossings != 0);
+    long cell = start, k = 0;
+    (*cells)[0] = cell;
+    for (; k < length; ++k)
+    {
+        int move = moves[k];
+        long row = cell / cols + RowStep[move];
+        long col = cell % cols + ColStep[move];
+        if (row < 0 || row >= rows || col < 0 || col >= cols) {break;}
+        long next = row * cols + col;
+
+        /* A move up or left crosses a wall of the cell it leaves, and a
+           move down or right a wall of the cell it enters. */
+        long owner = move == 0 || move == 1 ? cell : next;
+        (*crossings)[k] = owner * 2 + (move == 1 || move == 2);
+        (*cells)[k + 1] = cell = next;
+    }
+    free(moves);
+    if (k < length || cell != goal)
+    {
+        free(*cells);
+        free(*crossings);
+        *cells = *crossings = 0;
+        return -1;
+    }
+
+    qsort(*cells,length + 1,sizeof(long),compareLongs);
+    qsort(*crossings,length,sizeof(long),compareLongs);
+    return length + 1;
+}
+
+/* Writes the line of pixels along the top of a row of cells, followed by
+   the given number of lines across it, which are all alike. */
+static void drawRow(int cols,unsigned char *walls,unsigned char *marks,
+                    int pixels,int lines,int gray,unsigned char *line,
+                    FILE *fp)
+{
+    long width = (long)cols * pixels + 1;
+    unsigned char *top = line, *across = line + width;
+    unsigned char *bits = across + width;
+
+    for (int j = 0; j < cols; ++j)
+    {
+        long x = (long)j * pixels;
+        int topColor = walls[j] & 0x1 ? BLACK
+            : marks[j] & 0x2 ? GRAY : WHITE;
+        int leftColor = walls[j] & 0x2 ? BLACK
+            : marks[j] & 0x4 ? GRAY : WHITE;
+        top[x] = BLACK;
+        memset(top + x + 1,topColor,pixels - 1);
+        across[x] = leftColor;
+        memset(across + x + 1,marks[j] & 0x1 ? GRAY : WHITE,pixels - 1);
+    }
+    top[width - 1] = BLACK;
+    across[width - 1] = walls[cols-1] & 0x4 ? BLACK : WHITE;
+
+    putLine(top,width,gray,bits,fp);
+    if (lines == 0) {return;}
+    putLine(across,width,gray,bits,fp);
+    long bytes = gray ? width : (width + 7) / 8;
+    for (int k = 1; k < lines; ++k) {fwrite(gray ? across : bits,1,bytes,fp);}
+}
+
+/* PBM packs eight pixels to a byte, first pixel in the high bit, with 1
+   for black; gray pixels are drawn white. The packed line is left in bits
+   so that a line drawn again needn't be packed again. */
+static void putLine(unsigned char *pixels,long width,int gray,
+                    unsigned char *bits,FILE *fp)
+{
+    if (gray)
+    {
+        fwrite(pixels,1,width,fp);
+        return;
+    }
+    long bytes = (width + 7) / 8;
+    for (long k = 0; k < width / 8; ++k)
+    {
+        unsigned char *p = pixels + k * 8;
+        bits[k] = (p[0] == BLACK) << 7 | (p[1] == BLACK) << 6
+            | (p[2] == BLACK) << 5 | (p[3] == BLACK) << 4
+            | (p[4] == BLACK) << 3 | (p[5] == BLACK) << 2
+            | (p[6] == BLACK) << 1 | (p[7] == BLACK);
+    }
+    if (width % 8)
+    {
+        unsigned char byte = 0;
+        for (long x = width / 8 * 8; x < width; ++x)
+            byte |= (pixels[x] == BLACK) << (7 - x % 8);
+        bits[bytes - 1] = byte;
+    }
+    fwrite(bits,1,bytes,fp);
+}
+
+static int compareLongs(const void *a,const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
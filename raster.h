@@ -0,0 +1,11 @@
+#ifndef __RASTER_INCLUDED__
+#define __RASTER_INCLUDED__
+
+#include <stdio.h>
+
+#define RASTER_PIXELS 4
+
+extern int rasterMAZE(FILE *readFile,FILE *routeFile,FILE *writeFile,
+                      int pixels,int gray);
+
+#endif
@@ -0,0 +1,399 @@
+/***************************************************************************
+ * This module records only the path through a maze instead of the whole   *
+ * solved maze. The path is the list of moves from the entrance to the     *
+ * exit, each one of up, left, right, or down (the wall it crosses, 0 to   *
+ * 3). It is written either as text, in runs of the same move:             *
+ *                                                                         *
+ *   route rows cols startRow startCol goalRow goalCol length              *
+ *   R12 D3 L4 ...                                                         *
+ *                                                                         *
+ * with the letters U, L, R, and D and at most twelve runs to a line, or   *
+ * packed two bits to a move:                                              *
+ *                                                                         *
+ *   "MZRT" rows cols                    (unsigned 32-bit)                 *
+ *   start goal length                   (unsigned 64-bit)                 *
+ *   the moves, four to a byte, the first in the low two bits              *
+ *                                                                         *
+ * Integers are in the byte order of the machine that wrote them. The path *
+ * is found with a breadth first search that keeps each cell's way back in *
+ * the grid's direction bits, so the search needs only a queue and a bit   *
+ * per cell besides the grid. The search can also be run a few cells at a  *
+ * time through newSEARCH and stepSEARCH, for a program that draws it as   *
+ * it spreads; its queue holds every cell seen in order, so the frontier   *
+ * is one run of it. The cells changed by a step are two runs, those taken *
+ * off the front and those added at the back, with the waiting cells the   *
+ * step didn't touch in between, so they are copied out when asked for.    *
+ *                                                                         *
+ * traceROUTE follows a path over a maze, one move at a time, and sets the *
+ * values along it the way the solvers do, so the maze can be drawn with   *
+ * its path.                                                               *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "route.h"
+#include "grid.h"
+#include "maze.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+
+#define RUNS_PER_LINE 12
+
+static const char Letters[4] = {'U','L','R','D'};
+static const int RowStep[4] = {-1,0,0,1};
+static const int ColStep[4] = {0,-1,1,0};
+
+struct search
+{
+    GRID *g;
+    /* One bit per cell seen, and every cell seen in the order seen; the
+       cells from head to tail are still waiting. */
+    unsigned char *seen;
+    long *queue;
+    long head;
+    long tail;
+    /* Where head and tail were before the last step. */
+    long lastHead;
+    long lastTail;
+    /* The cells changed by the last step, copied when asked for. */
+    long *changed;
+    long changedCapacity;
+    long start;
+    long goal;
+    long cell;
+};
+
+static int  openTo(GRID *g,long cell,int wall,long *next);
+static long traceRun(GRID *g,long *cell,long *steps,int wall,long count);
+
+/* Fills moves with the moves of a shortest path from the entrance to the
+   exit and returns their number, or -1 if the exit can't be reached.
+   moves must have room for one move per cell. */
+long routeGRID(GRID *g,unsigned char *moves)
+{
+    SEARCH *s = newSEARCH(g);
+    long size = (long)getGRIDrows(g) * getGRIDcols(g);
+    while (!isSEARCHdone(s)) {stepSEARCH(s,size);}
+    long length = routeSEARCH(s,moves);
+    freeSEARCH(s);
+    return length;
+}
+
+/* Starts a breadth first search of the grid from its entrance. */
+SEARCH *newSEARCH(GRID *g)
+{
+    long size = (long)getGRIDrows(g) * getGRIDcols(g);
+    SEARCH *s = malloc(sizeof(SEARCH));
+    assert(s != 0);
+    s->g = g;
+    s->seen = calloc(size / 8 + 1,sizeof(unsigned char));
+    s->queue = malloc(sizeof(long) * size);
+    assert(s->seen != 0 && s->queue != 0);
+    s->start = getGRIDstart(g);
+    s->goal = getGRIDgoal(g);
+    s->cell = s->start;
+    s->head = s->tail = s->lastHead = s->lastTail = 0;
+    s->changed = 0;
+    s->changedCapacity = 0;
+    s->queue[s->tail++] = s->start;
+    s->seen[s->start / 8] |= 1 << (s->start % 8);
+    return s;
+}
+
+/* Takes at most cells cells off the queue, adding their unseen neighbors.
+   The search is done once it has seen the exit or has run out of cells.
+   Returns the number of cells taken. */
+long stepSEARCH(SEARCH *s,long cells)
+{
+    int cols = getGRIDcols(s->g);
+    long taken = 0;
+    s->lastHead = s->head;
+    s->lastTail = s->tail;
+    for (; taken < cells && !isSEARCHdone(s); ++taken)
+    {
+        long cell = s->queue[s->head++], next;
+        s->cell = cell;
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (!openTo(s->g,cell,wall,&next)) {continue;}
+            if (s->seen[next / 8] & (1 << (next % 8))) {continue;}
+            s->seen[next / 8] |= 1 << (next % 8);
+            setGRIDdir(s->g,next / cols,next % cols,3 - wall);
+            s->queue[s->tail++] = next;
+        }
+    }
+    return taken;
+}
+
+int isSEARCHdone(SEARCH *s)
+{
+    return s->head == s->tail || (s->seen[s->goal / 8] & (1 << (s->goal % 8)));
+}
+
+/* The cell last taken off the queue, or the entrance before the first
+   step. */
+long getSEARCHcell(SEARCH *s) {return s->cell;}
+
+/* Sets cells to the cells waiting in the queue and returns their number.
+   The cells are the search's own, good until the next step. */
+long getSEARCHfrontier(SEARCH *s,long **cells)
+{
+    *cells = s->queue + s->head;
+    return s->tail - s->head;
+}
+
+/* Sets cells to the cells that changed in the last step, those taken off
+   the queue followed by those added to it, and returns their number. The
+   cells are the search's own, good until the next call. */
+long getSEARCHchanged(SEARCH *s,long **cells)
+{
+    long taken = s->head - s->lastHead, added = s->tail - s->lastTail;
+    if (s->changed == 0 || taken + added > s->changedCapacity)
+    {
+        s->changedCapacity = taken + added + 1;
+        s->changed = realloc(s->changed,sizeof(long) * s->changedCapacity);
+        assert(s->changed != 0);
+    }
+    memcpy(s->changed,s->queue + s->lastHead,sizeof(long) * taken);
+    memcpy(s->changed + taken,s->queue + s->lastTail,sizeof(long) * added);
+    *cells = s->changed;
+    return taken + added;
+}
+
+/* Once the search is done, fills moves with the path to the exit the way
+   routeGRID does. Returns -1 if the exit wasn't reached. */
+long routeSEARCH(SEARCH *s,unsigned char *moves)
+{
+    int cols = getGRIDcols(s->g);
+    long start = s->start, goal = s->goal;
+    if (!(s->seen[goal / 8] & (1 << (goal % 8)))) {return -1;}
+
+    // Walk back from the exit, then put the moves in order.
+    long length = 0;
+    for (long cell = goal; cell != start; ++length)
+    {
+        int back = getGRIDdir(s->g,cell / cols,cell % cols);
+        moves[length] = 3 - back;
+        cell += RowStep[back] * (long)cols + ColStep[back];
+    }
+    for (long i = 0, j = length - 1; i < j; ++i, --j)
+    {
+        unsigned char move = moves[i];
+        moves[i] = moves[j];
+        moves[j] = move;
+    }
+    return length;
+}
+
+/* Frees the search but not its grid. */
+void freeSEARCH(SEARCH *s)
+{
+    free(s->changed);
+    free(s->seen);
+    free(s->queue);
+    free(s);
+}
+
+void writeROUTE(GRID *g,unsigned char *moves,long length,FILE *fp)
+{
+    int cols = getGRIDcols(g);
+    long start = getGRIDstart(g), goal = getGRIDgoal(g);
+    fprintf(fp,"route %d %d %ld %ld %ld %ld %ld\n",getGRIDrows(g),cols,
+        start / cols,start % cols,goal / cols,goal % cols,length);
+
+    int runs = 0;
+    for (long i = 0; i < length; )
+    {
+        long j = i;
+        while (j < length && moves[j] == moves[i]) {++j;}
+        fprintf(fp,"%c%ld",Letters[moves[i]],j - i);
+        i = j;
+        if (++runs % RUNS_PER_LINE == 0 || i == length) {fprintf(fp,"\n");}
+        else {fprintf(fp," ");}
+    }
+}
+
+void writeROUTEpacked(GRID *g,unsigned char *moves,long length,FILE *fp)
+{
+    uint32_t header[2] = {getGRIDrows(g),getGRIDcols(g)};
+    uint64_t ends[3] = {getGRIDstart(g),getGRIDgoal(g),length};
+    fwrite("MZRT",1,4,fp);
+    fwrite(header,sizeof(uint32_t),2,fp);
+    fwrite(ends,sizeof(uint64_t),3,fp);
+    for (long i = 0; i < length; i += 4)
+    {
+        unsigned char byte = 0;
+        for (int k = 0; k < 4 && i + k < length; ++k)
+            byte |= moves[i + k] << (2 * k);
+        putc(byte,fp);
+    }
+}
+
+/* Reads the path in the file, text or packed, for a maze of the given size.
+   Sets start and goal, sets moves to the moves, which the caller frees,
+   and returns their number, or -1 if the file doesn't hold a path for a
+   maze of this size. The walls are not checked. */
+long readROUTE(FILE *fp,int rows,int cols,long *start,long *goal,
+               unsigned char **moves)
+{
+    long size = (long)rows * cols, length = 0;
+    int packed = getc(fp);
+    ungetc(packed,fp);
+    packed = packed == 'M';
+    *moves = 0;
+
+    if (packed)
+    {
+        char magic[4];
+        uint32_t header[2];
+        uint64_t ends[3];
+        if (fread(magic,1,4,fp) != 4 || memcmp(magic,"MZRT",4) != 0 ||
+            fread(header,sizeof(uint32_t),2,fp) != 2 ||
+            fread(ends,sizeof(uint64_t),3,fp) != 3) {return -1;}
+        if ((int)header[0] != rows || (int)header[1] != cols) {return -1;}
+        if (ends[0] >= (uint64_t)size || ends[1] >= (uint64_t)size ||
+            ends[2] > LONG_MAX) {return -1;}
+        *start = ends[0];
+        *goal = ends[1];
+        length = ends[2];
+    }
+    else
+    {
+        int r1, c1, r2, c2, routeRows, routeCols;
+        if (fscanf(fp," route %d %d %d %d %d %d %ld",&routeRows,&routeCols,
+            &r1,&c1,&r2,&c2,&length) != 7) {return -1;}
+        if (routeRows != rows || routeCols != cols) {return -1;}
+        if (r1 < 0 || r1 >= rows || c1 < 0 || c1 >= cols || r2 < 0 ||
+            r2 >= rows || c2 < 0 || c2 >= cols || length < 0) {return -1;}
+        *start = (long)r1 * cols + c1;
+        *goal = (long)r2 * cols + c2;
+    }
+
+    /* The moves grow as they are read, so a length that the file doesn't
+       hold is found out before much is allocated. */
+    long steps = 0, capacity = 0;
+    while (steps < length)
+    {
+        if (packed)
+        {
+            int byte = getc(fp);
+            if (byte == EOF) {break;}
+            for (int k = 0; k < 4; ++k)
+            {
+                if (steps + k == capacity)
+                {
+                    capacity = capacity ? capacity * 2 : 64;
+                    *moves = realloc(*moves,capacity);
+                    assert(*moves != 0);
+                }
+                (*moves)[steps + k] = byte >> (2 * k) & 3;
+            }
+            steps += length - steps < 4 ? length - steps : 4;
+            continue;
+        }
+
+        char letter;
+        long count;
+        if (fscanf(fp," %c%ld",&letter,&count) != 2 || count < 1 ||
+            count > length - steps) {break;}
+        char *wall = memchr(Letters,letter,4);
+        if (wall == 0) {break;}
+        while (steps + count > capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            *moves = realloc(*moves,capacity);
+            assert(*moves != 0);
+        }
+        memset(*moves + steps,wall - Letters,count);
+        steps += count;
+    }
+    if (steps < length)
+    {
+        free(*moves);
+        *moves = 0;
+        return -1;
+    }
+    return length;
+}
+
+/* Follows the path in the file, text or packed, over the grid, setting the
+   value of each cell on it to its step number mod 10 and every other
+   value to -1. Returns the length of the path, or -1 if the file doesn't
+   hold a path through this maze. */
+long traceROUTE(GRID *g,FILE *fp)
+{
+    int rows = getGRIDrows(g), cols = getGRIDcols(g);
+    long start, goal;
+    unsigned char *moves;
+    long length = readROUTE(fp,rows,cols,&start,&goal,&moves);
+    if (length < 0) {return -1;}
+
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+            setGRIDval(g,i,j,-1);
+    long cell = start, steps = 0;
+    setGRIDval(g,start / cols,start % cols,0);
+    while (steps < length && traceRun(g,&cell,&steps,moves[steps],1) >= 0) {}
+    free(moves);
+    return steps == length && cell == goal ? length : -1;
+}
+
+/* Solves the maze and writes only its path, as text or packed. Returns the
+   length of the path, or -1 if the file isn't a maze or has no path. */
+long solveROUTE(FILE *readFile,FILE *writeFile,int packed)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return -1;}
+    long size = (long)getGRIDrows(g) * getGRIDcols(g);
+    unsigned char *moves = malloc(size);
+    assert(moves != 0);
+    long length = routeGRID(g,moves);
+    if (length >= 0 && packed) {writeROUTEpacked(g,moves,length,writeFile);}
+    else if (length >= 0) {writeROUTE(g,moves,length,writeFile);}
+    free(moves);
+    freeGRID(g);
+    return length;
+}
+
+/* Draws the maze with the path in the route file laid over it. Returns the
+   length of the path, or -1 if it doesn't fit the maze. */
+long drawROUTE(FILE *mazeFile,FILE *routeFile)
+{
+    GRID *g = readGRID(mazeFile);
+    if (g == 0) {return -1;}
+    long length = traceROUTE(g,routeFile);
+    if (length >= 0) {drawMAZEgrid(g);}
+    freeGRID(g);
+    return length;
+}
+
+/* Sets next to the cell through the wall if the wall is open and not an
+   outer wall. Returns 0 otherwise. */
+static int openTo(GRID *g,long cell,int wall,long *next)
+{
+    int cols = getGRIDcols(g);
+    int row = cell / cols + RowStep[wall], col = cell % cols + ColStep[wall];
+    if (getGRIDwalls(g,cell / cols,cell % cols) & (1 << wall)) {return 0;}
+    if (row < 0 || row >= getGRIDrows(g) || col < 0 || col >= cols)
+        return 0;
+    *next = (long)row * cols + col;
+    return 1;
+}
+
+/* Moves count times through the wall, numbering the cells passed. Returns
+   -1 if a wall is in the way. */
+static long traceRun(GRID *g,long *cell,long *steps,int wall,long count)
+{
+    int cols = getGRIDcols(g);
+    for (long k = 0; k < count; ++k)
+    {
+        if (!openTo(g,*cell,wall,cell)) {return -1;}
+        ++*steps;
+        setGRIDval(g,*cell / cols,*cell % cols,*steps % 10);
+    }
+    return *steps;
+}
@@ -0,0 +1,29 @@
+#ifndef __ROUTE_INCLUDED__
+#define __ROUTE_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+typedef struct search SEARCH;
+
+extern long routeGRID(GRID *g,unsigned char *moves);
+extern void writeROUTE(GRID *g,unsigned char *moves,long length,FILE *fp);
+extern void writeROUTEpacked(GRID *g,unsigned char *moves,long length,
+                             FILE *fp);
+extern long readROUTE(FILE *fp,int rows,int cols,long *start,long *goal,
+                      unsigned char **moves);
+extern long traceROUTE(GRID *g,FILE *fp);
+
+extern long solveROUTE(FILE *readFile,FILE *writeFile,int packed);
+extern long drawROUTE(FILE *mazeFile,FILE *routeFile);
+
+extern SEARCH *newSEARCH(GRID *g);
+extern long stepSEARCH(SEARCH *s,long cells);
+extern int  isSEARCHdone(SEARCH *s);
+extern long getSEARCHcell(SEARCH *s);
+extern long getSEARCHfrontier(SEARCH *s,long **cells);
+extern long getSEARCHchanged(SEARCH *s,long **cells);
+extern long routeSEARCH(SEARCH *s,unsigned char *moves);
+extern void freeSEARCH(SEARCH *s);
+
+#endif
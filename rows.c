@@ -0,0 +1,285 @@
+/***************************************************************************
+ * This module hands out the rows of a maze file one at a time, whatever   *
+ * its format, for the drawing modules that never need the whole maze in   *
+ * memory. Each row comes as the walls of its cells, in the bits used by   *
+ * getGRIDwalls, and their values, and may be cut to a run of its columns. *
+ *                                                                         *
+ * A binary grid has every cell at a fixed offset, so it seeks straight to *
+ * any row and reads only the columns asked for. An archive seeks through  *
+ * its index to the block holding a row and decodes that block. A text     *
+ * maze can only be read forward, through a buffer since scanf is far too  *
+ * slow, and seeking in it reads every row in between.                     *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "rows.h"
+#include "grid.h"
+#include "arch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#define BUFFER_BYTES 65536
+
+struct rows
+{
+    FILE *fp;
+    int rows;
+    int cols;
+    /* The row the next call to nextROWS hands out. */
+    int next;
+    /* The last whole row read from text or an archive, which nextROWS
+       cuts the asked for columns from. */
+    unsigned char *walls;
+    int *values;
+    /* Text mazes. */
+    char *buffer;
+    int length;
+    int pos;
+    /* Archives, a block of rows at a time. */
+    ARCHIVE *archive;
+    unsigned char *block;
+    int blockFirst;
+    int blockCount;
+    int blockPos;
+    /* Binary grids. */
+    int binary;
+    int32_t *values32;
+};
+
+static int readRow(ROWS *r);
+static int readText(ROWS *r);
+static int readNumber(ROWS *r,int *n);
+
+/* Reads the size of the maze and gets ready to hand out its rows. Returns
+   0 if the file isn't a maze. */
+ROWS *openROWS(FILE *fp)
+{
+    ROWS *r = calloc(1,sizeof(ROWS));
+    assert(r != 0);
+    r->fp = fp;
+
+    int first = getc(fp);
+    ungetc(first,fp);
+    if (first == 'M')
+    {
+        char magic[4];
+        if (fread(magic,1,4,fp) != 4) {first = 0;}
+        else if (memcmp(magic,"MZAR",4) == 0)
+        {
+            r->archive = openARCHIVEheader(fp);
+            if (r->archive)
+            {
+                r->rows = getARCHIVErows(r->archive);
+                r->cols = getARCHIVEcols(r->archive);
+                r->block = malloc((long)getARCHIVEblockRows(r->archive)
+                    * r->cols);
+                assert(r->block != 0);
+            }
+        }
+        else if (memcmp(magic,"MZGD",4) == 0)
+        {
+            uint32_t header[3];
+            uint64_t ends[2];
+            if (fread(header,sizeof(uint32_t),3,fp) == 3 &&
+                fread(ends,sizeof(uint64_t),2,fp) == 2)
+            {
+                r->binary = 1;
+                r->rows = header[0];
+                r->cols = header[1];
+            }
+        }
+    }
+    else
+    {
+        r->buffer = malloc(BUFFER_BYTES);
+        assert(r->buffer != 0);
+        if (!readNumber(r,&r->rows) || !readNumber(r,&r->cols))
+            r->rows = 0;
+    }
+
+    if (r->rows <= 0 || r->cols <= 0)
+    {
+        closeROWS(r);
+        return 0;
+    }
+    if (r->binary)
+    {
+        r->values32 = malloc(sizeof(int32_t) * r->cols);
+        assert(r->values32 != 0);
+    }
+    else
+    {
+        r->walls = malloc(r->cols);
+        r->values = malloc(sizeof(int) * r->cols);
+        assert(r->walls != 0 && r->values != 0);
+        for (int j = 0; j < r->cols; ++j) {r->values[j] = -1;}
+    }
+    return r;
+}
+
+int getROWSrows(ROWS *r) {return r->rows;}
+
+int getROWScols(ROWS *r) {return r->cols;}
+
+/* Moves to a row so that nextROWS hands it out next. Returns 0 if the file
+   is cut short, or if the row is behind a text maze that has already been
+   read past it. */
+int seekROWS(ROWS *r,int row)
+{
+    assert(row >= 0 && row < r->rows);
+    if (r->binary)
+    {
+        r->next = row;
+        return 1;
+    }
+
+    if (r->archive)
+    {
+        int blockRows = getARCHIVEblockRows(r->archive);
+        int inBlock = row >= r->blockFirst &&
+            row < r->blockFirst + r->blockCount;
+        if (!inBlock && seekARCHIVEblock(r->archive,row / blockRows))
+        {
+            r->blockFirst = r->next = row / blockRows * blockRows;
+            r->blockCount = r->blockPos = 0;
+        }
+        else if (inBlock)
+        {
+            r->blockPos = row - r->blockFirst;
+            r->next = row;
+            return 1;
+        }
+    }
+
+    if (row < r->next) {return 0;}
+    while (r->next < row)
+        if (!readRow(r)) {return 0;}
+    return 1;
+}
+
+/* Fills the walls and values of count cells of the next row, starting at
+   column col. values may be 0 when only walls are wanted; archives have
+   no values, so theirs are all -1. Returns 0 if the file is cut short. */
+int nextROWS(ROWS *r,unsigned char *walls,int *values,int col,int count)
+{
+    assert(col >= 0 && count > 0 && col + count <= r->cols);
+    if (r->binary)
+    {
+        long cols = r->cols, row = r->next++;
+        if (fseek(r->fp,GRID_HEADER_BYTES + row * cols + col,SEEK_SET) != 0
+            || fread(walls,1,count,r->fp) != (size_t)count) {return 0;}
+        for (int j = 0; j < count; ++j) {walls[j] &= 0xF;}
+        if (values == 0) {return 1;}
+        if (fseek(r->fp,GRID_HEADER_BYTES + r->rows * cols
+            + (row * cols + col) * sizeof(int32_t),SEEK_SET) != 0 ||
+            fread(r->values32,sizeof(int32_t),count,r->fp) != (size_t)count)
+            return 0;
+        for (int j = 0; j < count; ++j) {values[j] = r->values32[j];}
+        return 1;
+    }
+
+    if (!readRow(r)) {return 0;}
+    memcpy(walls,r->walls + col,count);
+    if (values) {memcpy(values,r->values + col,sizeof(int) * count);}
+    return 1;
+}
+
+/* Frees the reader but leaves its file open. */
+void closeROWS(ROWS *r)
+{
+    if (r->archive) {closeARCHIVE(r->archive);}
+    free(r->walls);
+    free(r->values);
+    free(r->block);
+    free(r->buffer);
+    free(r->values32);
+    free(r);
+}
+
+/* Reads the next whole row of a text maze or archive into walls and
+   values. */
+static int readRow(ROWS *r)
+{
+    if (r->archive == 0)
+    {
+        if (!readText(r)) {return 0;}
+        ++r->next;
+        return 1;
+    }
+    if (r->blockPos == r->blockCount)
+    {
+        r->blockFirst = r->next;
+        r->blockCount = nextARCHIVEblock(r->archive,r->block);
+        r->blockPos = 0;
+        if (r->blockCount <= 0)
+        {
+            r->blockCount = 0;
+            return 0;
+        }
+    }
+    memcpy(r->walls,r->block + (long)r->blockPos++ * r->cols,r->cols);
+    ++r->next;
+    return 1;
+}
+
+/* A text row is its left walls and values, its right wall, and then,
+   unless it is the last row, its bottom walls. Its top walls are the
+   bottom walls of the row before, which are still in walls. */
+static int readText(ROWS *r)
+{
+    unsigned char *walls = r->walls;
+    int cols = r->cols, row = r->next, wall;
+    for (int j = 0; j < cols; ++j)
+    {
+        int top = row == 0 ? 1 : walls[j] >> 3 & 1;
+        if (!readNumber(r,&wall) || !readNumber(r,&r->values[j])) {return 0;}
+        walls[j] = top | (wall != 0) << 1;
+        if (j > 0) {walls[j-1] |= (wall != 0) << 2;}
+    }
+    if (!readNumber(r,&wall)) {return 0;}
+    walls[cols-1] |= (wall != 0) << 2;
+    for (int j = 0; j < cols; ++j)
+    {
+        wall = 1;
+        if (row < r->rows - 1 && !readNumber(r,&wall)) {return 0;}
+        walls[j] |= (wall != 0) << 3;
+    }
+    return 1;
+}
+
+/* Reads the next whole number from a text maze. Returns 0 at the end of
+   the file or at anything that isn't a number. */
+static int readNumber(ROWS *r,int *n)
+{
+    int c, negative = 0, digits = 0;
+    long value = 0;
+    for (;;)
+    {
+        if (r->pos == r->length)
+        {
+            r->length = fread(r->buffer,1,BUFFER_BYTES,r->fp);
+            r->pos = 0;
+            if (r->length == 0) {break;}
+        }
+        c = r->buffer[r->pos];
+        if (c >= '0' && c <= '9')
+        {
+            value = value * 10 + (c - '0');
+            ++digits;
+        }
+        else if (c == '-' && digits == 0 && !negative) {negative = 1;}
+        else if (c == ' ' || c == '\n' || c == '\t' || c == '\r')
+        {
+            if (digits || negative) {break;}
+        }
+        else {break;}
+        ++r->pos;
+    }
+    if (digits == 0) {return 0;}
+    *n = negative ? -value : value;
+    return 1;
+}
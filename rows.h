@@ -0,0 +1,16 @@
+#ifndef __ROWS_INCLUDED__
+#define __ROWS_INCLUDED__
+
+#include <stdio.h>
+
+typedef struct rows ROWS;
+
+extern ROWS *openROWS(FILE *fp);
+extern int   getROWSrows(ROWS *r);
+extern int   getROWScols(ROWS *r);
+extern int   seekROWS(ROWS *r,int row);
+extern int   nextROWS(ROWS *r,unsigned char *walls,int *values,int col,
+                 int count);
+extern void  closeROWS(ROWS *r);
+
+#endif
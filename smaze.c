@@ -0,0 +1,410 @@
+/***************************************************************************
+ * This module stores a perfect maze in two bits per cell. A perfect maze  *
+ * is a tree, so rooting it at the entrance gives every other cell exactly *
+ * one parent, and the wall that leads to that parent (top, left, right,   *
+ * or bottom) is all that has to be kept. Every passage is the link from a *
+ * cell to its parent, so there is a passage behind wall w of a cell when  *
+ * the cell's own code is w or the neighbor's code is the opposite wall.   *
+ *                                                                         *
+ * Cells stay in row order, so the parent of a cell, the walls of a cell,  *
+ * and which neighbors are its children are each found from at most five   *
+ * codes in constant time. The solution is the chain of parents from the   *
+ * exit, so it is found without a search. drawSMAZE writes the maze for    *
+ * drawing straight from the codes.                                        *
+ *                                                                         *
+ * Depths, ancestor tests, and subtree sizes are not constant time. Depths *
+ * and ancestor tests follow the chain of parents, and subtreeSMAZE counts *
+ * a subtree by walking it with no stack, using each cell's code to find   *
+ * the way back up, so it takes time in proportion to the subtree. Sizes   *
+ * in constant time would need a preorder number and size kept for every   *
+ * cell, which is 64 bits a cell beside the two the codes take.            *
+ *                                                                         *
+ * The binary file format is:                                              *
+ *                                                                         *
+ *   "MZST" rows cols                   (unsigned 32-bit integers)         *
+ *   root goal                          (unsigned 64-bit integers)         *
+ *   codes, 32 cells to each word       (unsigned 64-bit integers)         *
+ *                                                                         *
+ * with cell i in bits 2(i mod 32) and up of word i / 32. Integers are in  *
+ * the byte order of the machine that wrote them.                          *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "smaze.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+struct smaze
+{
+    int rows;
+    int cols;
+    long root;
+    long goal;
+    uint64_t *codes;
+};
+
+static SMAZE *newSMAZE(int rows,int cols);
+static int    getCode(SMAZE *s,long cell);
+static void   setCode(SMAZE *s,long cell,int code);
+static long   neighbor(SMAZE *s,long cell,int wall);
+static int    outerWalls(SMAZE *s,long cell);
+static int    isTree(SMAZE *s);
+static int    compareLongs(const void *a,const void *b);
+
+/* Returns 0 if the grid is not a perfect maze. */
+SMAZE *encodeSMAZE(GRID *g)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    long size = (long)rows * cols;
+    SMAZE *s = newSMAZE(rows,cols);
+    s->root = getGRIDstart(g);
+    s->goal = getGRIDgoal(g);
+
+    /* Each cell is coded with the wall it was reached through, seen from
+       its own side. */
+    unsigned char *seen = calloc(size,1);
+    long *queue = malloc(sizeof(long) * size);
+    assert(seen != 0 && queue != 0);
+    long head = 0, tail = 0, passages = 0;
+    queue[tail++] = s->root;
+    seen[s->root] = 1;
+    while (head < tail)
+    {
+        long cell = queue[head++];
+        int row = cell / cols, col = cell % cols;
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            long next = neighbor(s,cell,wall);
+            if (next < 0 || getGRIDwall(g,row,col,wall)) {continue;}
+            ++passages;
+            if (seen[next]) {continue;}
+            seen[next] = 1;
+            setCode(s,next,3 - wall);
+            queue[tail++] = next;
+        }
+    }
+    free(queue);
+    free(seen);
+
+    // Each passage was seen from both sides.
+    if (tail != size || passages / 2 != size - 1)
+    {
+        freeSMAZE(s);
+        return 0;
+    }
+    return s;
+}
+
+GRID *decodeSMAZE(SMAZE *s)
+{
+    GRID *g = newGRID(s->rows,s->cols);
+    long size = (long)s->rows * s->cols;
+    for (long cell = 0; cell < size; ++cell)
+    {
+        if (cell == s->root) {continue;}
+        removeGRIDwall(g,cell / s->cols,cell % s->cols,getCode(s,cell));
+    }
+    setGRIDends(g,s->root / s->cols,s->root % s->cols,
+        s->goal / s->cols,s->goal % s->cols);
+    return g;
+}
+
+int getSMAZErows(SMAZE *s) {return s->rows;}
+
+int getSMAZEcols(SMAZE *s) {return s->cols;}
+
+long getSMAZEroot(SMAZE *s) {return s->root;}
+
+long getSMAZEgoal(SMAZE *s) {return s->goal;}
+
+/* Returns -1 for the root. */
+long parentSMAZE(SMAZE *s,long cell)
+{
+    if (cell == s->root) {return -1;}
+    return neighbor(s,cell,getCode(s,cell));
+}
+
+/* Returns the walls of a cell as bits 0 to 3, like getGRIDwalls. */
+int getSMAZEwalls(SMAZE *s,long cell)
+{
+    int walls = 0xF & ~childrenSMAZE(s,cell);
+    if (cell != s->root) {walls &= ~(1 << getCode(s,cell));}
+    return walls & ~outerWalls(s,cell);
+}
+
+/* Returns a bit for each wall that leads to a child. */
+int childrenSMAZE(SMAZE *s,long cell)
+{
+    int children = 0;
+    for (int wall = 0; wall < 4; ++wall)
+    {
+        long next = neighbor(s,cell,wall);
+        if (next >= 0 && next != s->root && getCode(s,next) == 3 - wall)
+            children |= 1 << wall;
+    }
+    return children;
+}
+
+long depthSMAZE(SMAZE *s,long cell)
+{
+    long depth = 0;
+    for (; cell != s->root; cell = parentSMAZE(s,cell)) {++depth;}
+    return depth;
+}
+
+int isSMAZEancestor(SMAZE *s,long ancestor,long cell)
+{
+    for (; cell != s->root; cell = parentSMAZE(s,cell))
+        if (cell == ancestor) {return 1;}
+    return ancestor == s->root;
+}
+
+/* Counts the cells below and including cell, in time proportional to the
+   count. The walk goes down through the lowest numbered child wall it
+   hasn't tried, and on the way back up the code of the cell it leaves
+   tells it which wall to try next. */
+long subtreeSMAZE(SMAZE *s,long cell)
+{
+    long count = 1, cur = cell;
+    int wall = 0;
+    while (1)
+    {
+        int children = childrenSMAZE(s,cur) >> wall << wall;
+        if (children)
+        {
+            cur = neighbor(s,cur,__builtin_ctz(children));
+            wall = 0;
+            ++count;
+            continue;
+        }
+        if (cur == cell) {break;}
+        wall = 3 - getCode(s,cur) + 1;
+        cur = parentSMAZE(s,cur);
+    }
+    return count;
+}
+
+/* Fills path, if given, with the cells from the entrance to the exit and
+   returns the number of steps. */
+long pathSMAZE(SMAZE *s,long *path)
+{
+    long steps = depthSMAZE(s,s->goal);
+    if (path)
+    {
+        long cell = s->goal;
+        for (long i = steps; i >= 0; --i)
+        {
+            path[i] = cell;
+            cell = parentSMAZE(s,cell);
+        }
+    }
+    return steps;
+}
+
+/* Writes the maze in the format drawMAZE reads, straight from the codes.
+   With showPath, the cells on the solution are numbered by step mod 10. */
+void drawSMAZE(SMAZE *s,int showPath,FILE *fp)
+{
+    int rows = s->rows, cols = s->cols;
+    long size = (long)rows * cols;
+
+    /* Path cells are met in row order, not path order, so each one is kept
+       as cell * 10 + step mod 10 and the list is sorted into row order. */
+    long steps = showPath ? pathSMAZE(s,0) : -1;
+    long *marks = malloc(sizeof(long) * (steps + 2));
+    assert(marks != 0);
+    if (showPath)
+    {
+        pathSMAZE(s,marks);
+        for (long i = 0; i <= steps; ++i) {marks[i] = marks[i] * 10 + i % 10;}
+        qsort(marks,steps + 1,sizeof(long),compareLongs);
+    }
+    long next = 0;
+
+    fprintf(fp,"%d %d\n",rows,cols);
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < cols; ++j)
+        {
+            long cell = (long)i * cols + j;
+            int value = -1;
+            if (next <= steps && marks[next] / 10 == cell)
+                value = marks[next++] % 10;
+            fprintf(fp,"%d %d ",getSMAZEwalls(s,cell) >> 1 & 1,value);
+        }
+        fprintf(fp,"%d\n",getSMAZEwalls(s,(long)i * cols + cols - 1) >> 2 & 1);
+
+        if (i < rows - 1)
+        {
+            for (int j = 0; j < cols; ++j)
+            {
+                fprintf(fp,"%d",getSMAZEwalls(s,(long)i * cols + j) >> 3 & 1);
+                if (j < cols - 1) {fprintf(fp," ");}
+            }
+            fprintf(fp,"\n");
+        }
+    }
+    if (s->root != 0 || s->goal != size - 1)
+        fprintf(fp,"ends %ld %ld %ld %ld\n",s->root / cols,s->root % cols,
+            s->goal / cols,s->goal % cols);
+    free(marks);
+}
+
+void writeSMAZE(SMAZE *s,FILE *fp)
+{
+    long size = (long)s->rows * s->cols;
+    uint32_t header[2] = {s->rows,s->cols};
+    uint64_t ends[2] = {s->root,s->goal};
+    fwrite("MZST",1,4,fp);
+    fwrite(header,sizeof(uint32_t),2,fp);
+    fwrite(ends,sizeof(uint64_t),2,fp);
+    fwrite(s->codes,sizeof(uint64_t),size / 32 + 1,fp);
+}
+
+/* Returns 0 if the file doesn't hold a packed maze. */
+SMAZE *readSMAZE(FILE *fp)
+{
+    char magic[4];
+    if (fread(magic,1,4,fp) != 4) {return 0;}
+    return readSMAZEmagic(fp,magic);
+}
+
+/* Reads the rest of a packed maze whose four byte magic has already been
+   read, like readGRIDmagic. Returns 0 for any other magic. */
+SMAZE *readSMAZEmagic(FILE *fp,const char *magic)
+{
+    uint32_t header[2];
+    uint64_t ends[2];
+    if (memcmp(magic,"MZST",4) != 0) {return 0;}
+    if (fread(header,sizeof(uint32_t),2,fp) != 2) {return 0;}
+    if (fread(ends,sizeof(uint64_t),2,fp) != 2) {return 0;}
+    if (header[0] == 0 || header[1] == 0) {return 0;}
+
+    SMAZE *s = newSMAZE(header[0],header[1]);
+    long size = (long)s->rows * s->cols;
+    s->root = ends[0];
+    s->goal = ends[1];
+    if (fread(s->codes,sizeof(uint64_t),size / 32 + 1,fp) !=
+        (size_t)(size / 32 + 1) || s->root >= size || s->goal >= size ||
+        !isTree(s))
+    {
+        freeSMAZE(s);
+        return 0;
+    }
+    return s;
+}
+
+void freeSMAZE(SMAZE *s)
+{
+    free(s->codes);
+    free(s);
+}
+
+/* Returns 0 if the file doesn't hold a perfect maze. */
+int packSMAZE(FILE *readFile,FILE *writeFile)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return 0;}
+    SMAZE *s = encodeSMAZE(g);
+    freeGRID(g);
+    if (s == 0) {return 0;}
+    writeSMAZE(s,writeFile);
+    freeSMAZE(s);
+    return 1;
+}
+
+/* Writes the maze with its solution for drawing and returns the number
+   of steps, or -1 if the file doesn't hold a packed maze. */
+long solveSMAZE(FILE *readFile,FILE *writeFile)
+{
+    SMAZE *s = readSMAZE(readFile);
+    if (s == 0) {return -1;}
+    long steps = pathSMAZE(s,0);
+    drawSMAZE(s,1,writeFile);
+    freeSMAZE(s);
+    return steps;
+}
+
+static SMAZE *newSMAZE(int rows,int cols)
+{
+    SMAZE *s = malloc(sizeof(SMAZE));
+    assert(s != 0);
+    long size = (long)rows * cols;
+    s->rows = rows;
+    s->cols = cols;
+    s->root = 0;
+    s->goal = size - 1;
+    s->codes = calloc(size / 32 + 1,sizeof(uint64_t));
+    assert(s->codes != 0);
+    return s;
+}
+
+static int getCode(SMAZE *s,long cell)
+{
+    return s->codes[cell / 32] >> (cell % 32 * 2) & 3;
+}
+
+static void setCode(SMAZE *s,long cell,int code)
+{
+    int shift = cell % 32 * 2;
+    s->codes[cell / 32] = (s->codes[cell / 32] & ~((uint64_t)3 << shift))
+        | (uint64_t)code << shift;
+}
+
+/* Returns the cell behind a wall, or -1 at the edge of the maze. */
+static long neighbor(SMAZE *s,long cell,int wall)
+{
+    int row = cell / s->cols, col = cell % s->cols;
+    switch (wall)
+    {
+        case 0: return row > 0 ? cell - s->cols : -1;
+        case 1: return col > 0 ? cell - 1 : -1;
+        case 2: return col < s->cols - 1 ? cell + 1 : -1;
+        default: return row < s->rows - 1 ? cell + s->cols : -1;
+    }
+}
+
+/* Returns the outer walls opened for the entrance and exit, in the same
+   places setGRIDends opens them. */
+static int outerWalls(SMAZE *s,long cell)
+{
+    int open = 0;
+    int col = cell % s->cols;
+    if (cell == s->root)
+    {
+        if (col == 0) {open |= 0x2;}
+        else if (col == s->cols - 1) {open |= 0x4;}
+    }
+    if (cell == s->goal)
+    {
+        if (col == s->cols - 1) {open |= 0x4;}
+        else if (col == 0) {open |= 0x2;}
+    }
+    return open;
+}
+
+/* Returns 1 if every cell but the root has a parent inside the maze and
+   the chains of parents all reach the root. Codes read from a file may
+   instead run off the edge or go round in a loop, which would leave the
+   parent walks stuck. The cells whose chains reach the root are exactly
+   those below it, so counting the root's subtree checks them all. */
+static int isTree(SMAZE *s)
+{
+    long size = (long)s->rows * s->cols;
+    for (long cell = 0; cell < size; ++cell)
+        if (cell != s->root && neighbor(s,cell,getCode(s,cell)) < 0)
+            return 0;
+    return subtreeSMAZE(s,s->root) == size;
+}
+
+static int compareLongs(const void *a,const void *b)
+{
+    long x = *(const long *)a, y = *(const long *)b;
+    return (x > y) - (x < y);
+}
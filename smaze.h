@@ -0,0 +1,31 @@
+#ifndef __SMAZE_INCLUDED__
+#define __SMAZE_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+typedef struct smaze SMAZE;
+
+extern SMAZE *encodeSMAZE(GRID *g);
+extern GRID  *decodeSMAZE(SMAZE *s);
+extern int    getSMAZErows(SMAZE *s);
+extern int    getSMAZEcols(SMAZE *s);
+extern long   getSMAZEroot(SMAZE *s);
+extern long   getSMAZEgoal(SMAZE *s);
+extern long   parentSMAZE(SMAZE *s,long cell);
+extern int    getSMAZEwalls(SMAZE *s,long cell);
+extern int    childrenSMAZE(SMAZE *s,long cell);
+extern long   depthSMAZE(SMAZE *s,long cell);
+extern int    isSMAZEancestor(SMAZE *s,long ancestor,long cell);
+extern long   subtreeSMAZE(SMAZE *s,long cell);
+extern long   pathSMAZE(SMAZE *s,long *path);
+extern void   drawSMAZE(SMAZE *s,int showPath,FILE *fp);
+extern void   writeSMAZE(SMAZE *s,FILE *fp);
+extern SMAZE *readSMAZE(FILE *fp);
+extern SMAZE *readSMAZEmagic(FILE *fp,const char *magic);
+extern void   freeSMAZE(SMAZE *s);
+
+extern int  packSMAZE(FILE *readFile,FILE *writeFile);
+extern long solveSMAZE(FILE *readFile,FILE *writeFile);
+
+#endif
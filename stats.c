@@ -0,0 +1,268 @@
+/***************************************************************************
+ * This module measures how hard a maze is and writes what it finds as     *
+ * JSON: the number of cells with each number of passages (dead ends have  *
+ * one and junctions three or four), the lengths of the corridors, which   *
+ * are runs of cells with two passages, the length of the solution and the *
+ * number of junctions along it, and the diameter, the longest shortest    *
+ * path between any two cells.                                             *
+ *                                                                         *
+ * Everything is found in linear time with one scan of the cells and two   *
+ * breadth first searches. The first search starts at the entrance, which  *
+ * gives the solution, and the cell it reaches last is one end of a        *
+ * longest path in a tree. The second search starts from that cell, and    *
+ * the cell it reaches last is the other end. In a maze with loops the     *
+ * diameter found this way may be short of the true one.                   *
+ *                                                                         *
+ * hardenMAZE moves the entrance and exit to the ends of the diameter,     *
+ * which gives the maze the longest solution it can have.                  *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "stats.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+static unsigned char *findDegrees(GRID *g);
+static long search(GRID *g,long from,int *dist,int *queue,long *last);
+static int  compareInts(const void *a,const void *b);
+
+static int RowStep[4] = {-1,0,0,1};
+static int ColStep[4] = {0,-1,1,0};
+
+void statsGRID(GRID *g,FILE *json)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    assert((long)rows * cols <= INT_MAX);
+    int size = rows * cols;
+
+    unsigned char *degree = findDegrees(g);
+    int *dist = malloc(sizeof(int) * size);
+    int *queue = malloc(sizeof(int) * size);
+    assert(dist != 0 && queue != 0);
+
+    long degrees[5] = {0,0,0,0,0};
+    long passages = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        ++degrees[degree[i]];
+        passages += degree[i];
+    }
+    passages /= 2;
+
+    /* Corridors: flood each run of cells with two passages, keeping the
+       run lengths in dist until they are sorted and counted. */
+    unsigned char *seen = calloc(size,1);
+    assert(seen != 0);
+    int corridors = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        if (degree[i] != 2 || seen[i]) {continue;}
+        int top = 0, length = 0;
+        queue[top++] = i;
+        seen[i] = 1;
+        while (top > 0)
+        {
+            int cell = queue[--top];
+            ++length;
+            int row = cell / cols, col = cell % cols;
+            for (int wall = 0; wall < 4; ++wall)
+            {
+                int r = row + RowStep[wall], c = col + ColStep[wall];
+                if (r < 0 || r >= rows || c < 0 || c >= cols) {continue;}
+                if (getGRIDwall(g,row,col,wall)) {continue;}
+                int next = r * cols + c;
+                if (degree[next] == 2 && !seen[next])
+                {
+                    seen[next] = 1;
+                    queue[top++] = next;
+                }
+            }
+        }
+        dist[corridors++] = length;
+    }
+    free(seen);
+    qsort(dist,corridors,sizeof(int),compareInts);
+
+    fprintf(json,"{\n");
+    fprintf(json,"  \"rows\": %d,\n",rows);
+    fprintf(json,"  \"cols\": %d,\n",cols);
+    fprintf(json,"  \"cells\": %d,\n",size);
+    fprintf(json,"  \"passages\": %ld,\n",passages);
+    fprintf(json,"  \"deadEnds\": %ld,\n",degrees[1]);
+    fprintf(json,"  \"junctions\": %ld,\n",degrees[3] + degrees[4]);
+    fprintf(json,"  \"degrees\": [%ld, %ld, %ld, %ld, %ld],\n",degrees[0],
+        degrees[1],degrees[2],degrees[3],degrees[4]);
+    fprintf(json,"  \"corridors\": {\"count\": %d, \"longest\": %d, "
+        "\"lengths\": {",corridors,corridors ? dist[corridors-1] : 0);
+    for (int i = 0; i < corridors; )
+    {
+        int j = i;
+        while (j < corridors && dist[j] == dist[i]) {++j;}
+        fprintf(json,"%s\"%d\": %d",i ? ", " : "",dist[i],j - i);
+        i = j;
+    }
+    fprintf(json,"}},\n");
+
+    /* The first search gives the solution and one end of the diameter. */
+    long start = getGRIDstart(g), goal = getGRIDgoal(g);
+    long first = start, second = start;
+    long reached = search(g,start,dist,queue,&first);
+    fprintf(json,"  \"perfect\": %s,\n",
+        reached == size && passages == size - 1 ? "true" : "false");
+    if (dist[goal] < 0) {fprintf(json,"  \"solution\": null,\n");}
+    else
+    {
+        /* Walk back from the exit counting the junctions passed. */
+        long decisions = 0;
+        long cell = goal;
+        while (cell != start)
+        {
+            if (degree[cell] >= 3) {++decisions;}
+            int row = cell / cols, col = cell % cols;
+            for (int wall = 0; wall < 4; ++wall)
+            {
+                int r = row + RowStep[wall], c = col + ColStep[wall];
+                if (r < 0 || r >= rows || c < 0 || c >= cols) {continue;}
+                if (getGRIDwall(g,row,col,wall)) {continue;}
+                if (dist[r * cols + c] == dist[cell] - 1)
+                {
+                    cell = r * cols + c;
+                    break;
+                }
+            }
+        }
+        if (degree[start] >= 3) {++decisions;}
+        fprintf(json,"  \"solution\": {\"start\": [%ld, %ld], \"goal\": "
+            "[%ld, %ld], \"length\": %d, \"junctions\": %ld},\n",
+            start / cols,start % cols,goal / cols,goal % cols,dist[goal],
+            decisions);
+    }
+
+    search(g,first,dist,queue,&second);
+    fprintf(json,"  \"diameter\": {\"length\": %d, \"ends\": [[%ld, %ld], "
+        "[%ld, %ld]]}\n",dist[second],first / cols,first % cols,
+        second / cols,second % cols);
+    fprintf(json,"}\n");
+
+    free(degree);
+    free(dist);
+    free(queue);
+}
+
+/* Stores the ends of the diameter of the part of the maze reachable from
+   the entrance, and returns its length. */
+long farthestGRID(GRID *g,long *first,long *second)
+{
+    long size = (long)getGRIDrows(g) * getGRIDcols(g);
+    assert(size <= INT_MAX);
+    int *dist = malloc(sizeof(int) * size);
+    int *queue = malloc(sizeof(int) * size);
+    assert(dist != 0 && queue != 0);
+
+    search(g,getGRIDstart(g),dist,queue,first);
+    search(g,*first,dist,queue,second);
+    long length = dist[*second];
+
+    free(dist);
+    free(queue);
+    return length;
+}
+
+/* Returns 0 if the file doesn't hold a maze. */
+int statsMAZE(FILE *readFile,FILE *json)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return 0;}
+    statsGRID(g,json);
+    freeGRID(g);
+    return 1;
+}
+
+/* Writes the maze with its entrance and exit moved to the ends of its
+   diameter and returns the new solution length, or -1 if the file doesn't
+   hold a maze. The end nearer the first cell becomes the entrance. */
+long hardenMAZE(FILE *readFile,FILE *writeFile)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return -1;}
+    int cols = getGRIDcols(g);
+
+    long first, second;
+    long length = farthestGRID(g,&first,&second);
+    if (second < first) {long swap = first; first = second; second = swap;}
+    setGRIDends(g,first / cols,first % cols,second / cols,second % cols);
+
+    writeGRID(g,writeFile);
+    freeGRID(g);
+    return length;
+}
+
+/* Returns the number of passages out of each cell. The entrance and exit
+   lead out of the maze, so they don't count. */
+static unsigned char *findDegrees(GRID *g)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    unsigned char *degree = malloc((long)rows * cols);
+    assert(degree != 0);
+
+    for (int i = 0; i < rows; ++i)
+        for (int j = 0; j < cols; ++j)
+        {
+            int walls = getGRIDwalls(g,i,j);
+            int count = 0;
+            if (i > 0 && !(walls & 0x1)) {++count;}
+            if (j > 0 && !(walls & 0x2)) {++count;}
+            if (j < cols - 1 && !(walls & 0x4)) {++count;}
+            if (i < rows - 1 && !(walls & 0x8)) {++count;}
+            degree[(long)i * cols + j] = count;
+        }
+    return degree;
+}
+
+/* Breadth first search filling dist with steps from a cell, or -1 where
+   it can't reach. Stores the last cell reached and returns how many cells
+   were reached. */
+static long search(GRID *g,long from,int *dist,int *queue,long *last)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    long size = (long)rows * cols;
+    for (long i = 0; i < size; ++i) {dist[i] = -1;}
+
+    long head = 0, tail = 0;
+    dist[from] = 0;
+    queue[tail++] = from;
+    while (head < tail)
+    {
+        int cell = queue[head++];
+        int row = cell / cols, col = cell % cols;
+        int walls = getGRIDwalls(g,row,col);
+        for (int wall = 0; wall < 4; ++wall)
+        {
+            if (walls & (1 << wall)) {continue;}
+            int r = row + RowStep[wall], c = col + ColStep[wall];
+            if (r < 0 || r >= rows || c < 0 || c >= cols) {continue;}
+            int next = r * cols + c;
+            if (dist[next] == -1)
+            {
+                dist[next] = dist[cell] + 1;
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    *last = queue[tail-1];
+    return tail;
+}
+
+static int compareInts(const void *a,const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
@@ -0,0 +1,12 @@
+#ifndef __STATS_INCLUDED__
+#define __STATS_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+extern void statsGRID(GRID *g,FILE *json);
+extern long farthestGRID(GRID *g,long *first,long *second);
+extern int  statsMAZE(FILE *readFile,FILE *json);
+extern long hardenMAZE(FILE *readFile,FILE *writeFile);
+
+#endif
@@ -0,0 +1,667 @@
+/***************************************************************************
+ * This module solves perfect mazes one row at a time, so the whole maze   *
+ * never has to be held in memory. Instead of the maze, a small forest is  *
+ * kept that has the same distances between the cells of the current row,  *
+ * the start, and the goal as the part of the maze read so far. Cells that *
+ * are no longer needed are removed from it: dead ends are pruned, and     *
+ * cells with only two neighbors are replaced by one longer edge. Every    *
+ * cell left in the forest is a real cell, so it has at most four edges    *
+ * and the forest never grows past a few nodes per column.                 *
+ *                                                                         *
+ * streamLENGTH makes one forward pass and returns the length of the path  *
+ * from the start to the goal. streamSOLVE also saves the forest of every  *
+ * row to a temporary file. A backward pass then builds the same kind of   *
+ * forest for the rows below each row and joins the two, which gives the   *
+ * exact path through that row. The path cells are written with their     *
+ * step values in the same format as the maze class; all other cells are   *
+ * written with a value of -1.                                             *
+ *                                                                         *
+ * The start and goal are the corners unless the file ends with an ends    *
+ * line. That line comes after all the rows, so it is found first by       *
+ * reading only the last few bytes of the file; input from a pipe is       *
+ * copied to a temporary file so that it can be read this way.             *
+ *                                                                         *
+ * Both functions return -1 if the goal cannot be reached and -2 if the    *
+ * maze has a loop, since the forest only works on perfect mazes.          *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* The ends line is always in this many bytes at the end of the file. */
+#define TAIL_BYTES 64
+
+/* Node flags. */
+#define ALIVE    1
+#define TERMINAL 2
+#define START    4
+#define GOAL     8
+#define PREFIX   16
+
+typedef struct forest
+{
+    int cap;
+    int *adj;      /* four neighbor slots per node */
+    int *weight;   /* length of the edge in the matching slot */
+    int *deg;
+    unsigned char *flags;
+    int *freeList;
+    int freeCount;
+    int *work;     /* scratch worklist, twice the capacity */
+    int *parent;   /* scratch union-find sets and search parents */
+    long *dist;    /* scratch search distances */
+} FOREST;
+
+typedef struct row
+{
+    int *left;     /* left wall of each cell */
+    int *values;
+    int right;
+    int *bottom;   /* bottom wall of each cell */
+} ROW;
+
+static FOREST *newFOREST(int cap);
+static int  addNode(FOREST *f,int flags);
+static void freeNode(FOREST *f,int x);
+static void addEdge(FOREST *f,int u,int v,int w);
+static void removeEdge(FOREST *f,int u,int v);
+static void compress(FOREST *f);
+static void initSets(FOREST *f);
+static int  findSet(FOREST *f,int x);
+static int  joinSets(FOREST *f,int u,int v);
+static void searchFrom(FOREST *f,int source);
+static void freeFOREST(FOREST *f);
+
+static ROW *newROW(int cols);
+static int  readROW(FILE *fp,ROW *r,int cols,int hasBottom);
+static void writeROW(FILE *fp,ROW *r,int cols,int hasBottom);
+static void freeROW(ROW *r);
+
+static FILE *seekable(FILE *in);
+static void readEnds(FILE *fp,int rows,int cols,long *start,long *goal);
+static long forwardPass(FILE *in,FILE *summary,long *start,long *goal);
+static long backwardPass(FILE *rowFile,FILE *summary,FILE *marks,
+                         int rows,int cols,long start,long goal);
+static void emitSolution(FILE *rowFile,FILE *marks,FILE *out,
+                         long start,long goal);
+static void writeRecord(FILE *fp,long offset,int sNode,int gNode,int *term,
+                        FOREST *f,int cols);
+static long readRecord(FILE *fp,long end,long *offset,int *sNode,int *gNode,
+                       int *term,int **edges,int *numEdges,int cols);
+
+long streamLENGTH(FILE *readFile)
+{
+    FILE *in = seekable(readFile);
+    long start, goal;
+    long length = forwardPass(in,0,&start,&goal);
+    if (in != readFile) {fclose(in);}
+    return length;
+}
+
+long streamSOLVE(FILE *readFile,FILE *writeFile)
+{
+    FILE *summary = tmpfile();
+    FILE *marks = tmpfile();
+    FILE *rowFile = seekable(readFile);
+    assert(summary != 0 && marks != 0);
+
+    long start, goal;
+    long length = forwardPass(rowFile,summary,&start,&goal);
+    if (length >= 0)
+    {
+        int rows = 0, cols = 0;
+        rewind(rowFile);
+        fscanf(rowFile,"%d %d",&rows,&cols);
+        backwardPass(rowFile,summary,marks,rows,cols,start,goal);
+        emitSolution(rowFile,marks,writeFile,start,goal);
+    }
+
+    if (rowFile != readFile) {fclose(rowFile);}
+    fclose(marks);
+    fclose(summary);
+    return length;
+}
+
+/* Returns in if it can seek, or else a temporary copy of the rest of it,
+   since a pipe cannot be read twice. */
+static FILE *seekable(FILE *in)
+{
+    if (fseek(in,0,SEEK_CUR) == 0) {return in;}
+
+    FILE *spool = tmpfile();
+    assert(spool != 0);
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer,1,sizeof(buffer),in)) > 0)
+        fwrite(buffer,1,count,spool);
+    rewind(spool);
+    return spool;
+}
+
+/* Sets the start and goal from the ends line at the end of the file, or to
+   the corners if there is none, leaving the file where it was. */
+static void readEnds(FILE *fp,int rows,int cols,long *start,long *goal)
+{
+    *start = 0;
+    *goal = (long)rows * cols - 1;
+
+    long at = ftell(fp);
+    fseek(fp,0,SEEK_END);
+    long size = ftell(fp);
+    long from = size > TAIL_BYTES ? size - TAIL_BYTES : 0;
+    char tail[TAIL_BYTES + 1];
+    fseek(fp,from,SEEK_SET);
+    size_t count = fread(tail,1,size - from,fp);
+    tail[count] = '\0';
+    fseek(fp,at,SEEK_SET);
+
+    /* Only the ends line has letters after the rows and the costs. */
+    char *line = 0;
+    for (char *p = strstr(tail,"ends"); p != 0; p = strstr(p + 1,"ends"))
+        line = p;
+    int ends[4];
+    if (line == 0 || sscanf(line + 4,"%d %d %d %d",&ends[0],&ends[1],
+        &ends[2],&ends[3]) != 4) {return;}
+    if (ends[0] < 0 || ends[0] >= rows || ends[1] < 0 || ends[1] >= cols ||
+        ends[2] < 0 || ends[2] >= rows || ends[3] < 0 || ends[3] >= cols)
+        return;
+    *start = (long)ends[0] * cols + ends[1];
+    *goal = (long)ends[2] * cols + ends[3];
+}
+
+/* Reads the maze top to bottom, keeping only the forest of the rows read so
+   far, and sets the start and goal. If summary is given, the forest is
+   saved after each row is joined to the rows above it. in must be able to
+   seek. */
+static long forwardPass(FILE *in,FILE *summary,long *start,long *goal)
+{
+    int rows = 0, cols = 0;
+    if (fscanf(in,"%d %d",&rows,&cols) != 2 || rows < 1 || cols < 1)
+        return -1;
+    readEnds(in,rows,cols,start,goal);
+
+    FOREST *f = newFOREST(5 * cols + 8);
+    ROW *above = newROW(cols);
+    ROW *cur = newROW(cols);
+    int *term = malloc(sizeof(int) * cols);
+    int *prevTerm = malloc(sizeof(int) * cols);
+    assert(term != 0 && prevTerm != 0);
+    int sNode = -1, gNode = -1;
+    long result = 0;
+
+    for (int k = 0; k < rows && result == 0; ++k)
+    {
+        long offset = ftell(in);
+        if (!readROW(in,cur,cols,k < rows - 1)) {result = -1; break;}
+
+        for (int c = 0; c < cols; ++c)
+        {
+            long cell = (long)k * cols + c;
+            int ends = (cell == *start ? START : 0) |
+                       (cell == *goal ? GOAL : 0);
+            term[c] = addNode(f,TERMINAL | ends);
+            if (cell == *start) {sNode = term[c];}
+            if (cell == *goal) {gNode = term[c];}
+            if (k > 0 && !above->bottom[c]) {addEdge(f,prevTerm[c],term[c],1);}
+        }
+
+        /* The row above is no longer part of the frontier. */
+        if (k > 0)
+            for (int c = 0; c < cols; ++c)
+                f->flags[prevTerm[c]] &= ~TERMINAL;
+        compress(f);
+        if (summary) {writeRecord(summary,offset,sNode,gNode,term,f,cols);}
+
+        initSets(f);
+        for (int c = 1; c < cols; ++c)
+        {
+            if (cur->left[c]) {continue;}
+            if (!joinSets(f,term[c-1],term[c])) {result = -2; break;}
+            addEdge(f,term[c-1],term[c],1);
+        }
+
+        int *swapTerm = prevTerm; prevTerm = term; term = swapTerm;
+        ROW *swapRow = above; above = cur; cur = swapRow;
+    }
+
+    if (result == 0)
+    {
+        searchFrom(f,sNode);
+        result = f->dist[gNode];
+    }
+
+    free(prevTerm);
+    free(term);
+    freeROW(cur);
+    freeROW(above);
+    freeFOREST(f);
+    return result;
+}
+
+/* Reads the maze bottom to top, keeping the forest of the rows below. Each
+   row's forest is joined with the forest saved for the rows above it, which
+   gives the whole maze in miniature and the path cells of that row. */
+static long backwardPass(FILE *rowFile,FILE *summary,FILE *marks,
+                         int rows,int cols,long start,long goal)
+{
+    FOREST *f = newFOREST(5 * cols + 8);
+    ROW *cur = newROW(cols);
+    int *term = malloc(sizeof(int) * cols);
+    int *prevTerm = malloc(sizeof(int) * cols);
+    int *prefixTerm = malloc(sizeof(int) * cols);
+    int *map = malloc(sizeof(int) * (5 * cols + 8));
+    int *colOf = malloc(sizeof(int) * (5 * cols + 8));
+    signed char *rowMarks = malloc(sizeof(signed char) * cols);
+    assert(term && prevTerm && prefixTerm && map && colOf && rowMarks);
+    for (int i = 0; i < 5 * cols + 8; ++i)
+    {
+        map[i] = -1;
+        colOf[i] = -1;
+    }
+
+    fseek(summary,0,SEEK_END);
+    long end = ftell(summary);
+    /* The start and goal once this pass has reached their rows. */
+    int sNode = -1, gNode = -1;
+    long length = -1;
+
+    for (int k = rows - 1; k >= 0; --k)
+    {
+        long offset;
+        int sPrefix, gPrefix, numEdges;
+        int *edges;
+        end = readRecord(summary,end,&offset,&sPrefix,&gPrefix,prefixTerm,
+                         &edges,&numEdges,cols);
+        fseek(rowFile,offset,SEEK_SET);
+        readROW(rowFile,cur,cols,k < rows - 1);
+
+        /* Add this row to the forest of the rows below it. */
+        for (int c = 0; c < cols; ++c)
+        {
+            long cell = (long)k * cols + c;
+            int ends = (cell == start ? START : 0) | (cell == goal ? GOAL : 0);
+            term[c] = addNode(f,TERMINAL | ends);
+            colOf[term[c]] = c;
+            if (cell == start) {sNode = term[c];}
+            if (cell == goal) {gNode = term[c];}
+            if (c > 0 && !cur->left[c]) {addEdge(f,term[c-1],term[c],1);}
+            if (k < rows - 1 && !cur->bottom[c])
+                addEdge(f,term[c],prevTerm[c],1);
+        }
+        if (k < rows - 1)
+            for (int c = 0; c < cols; ++c)
+            {
+                f->flags[prevTerm[c]] &= ~TERMINAL;
+                colOf[prevTerm[c]] = -1;
+            }
+
+        /* Join the saved forest of the rows above, sharing this row. The
+           start or goal is in that forest if it is above this row. */
+        for (int c = 0; c < cols; ++c)
+            map[prefixTerm[c]] = term[c];
+        for (int e = 0; e < numEdges; ++e)
+        {
+            for (int side = 0; side < 2; ++side)
+                if (map[edges[3*e+side]] == -1)
+                    map[edges[3*e+side]] = addNode(f,PREFIX);
+            addEdge(f,map[edges[3*e]],map[edges[3*e+1]],edges[3*e+2]);
+        }
+        if (sPrefix != -1 && map[sPrefix] == -1)
+            map[sPrefix] = addNode(f,PREFIX);
+        if (gPrefix != -1 && map[gPrefix] == -1)
+            map[gPrefix] = addNode(f,PREFIX);
+        int from = sPrefix != -1 ? map[sPrefix] : sNode;
+        int to = gPrefix != -1 ? map[gPrefix] : gNode;
+
+        /* Walk the path back from the goal, marking this row's cells. */
+        searchFrom(f,from);
+        for (int c = 0; c < cols; ++c)
+            rowMarks[c] = -1;
+        if (f->dist[to] >= 0)
+        {
+            if (k == rows - 1) {length = f->dist[to];}
+            for (int x = to; x != -1; x = f->parent[x])
+                if (colOf[x] != -1) {rowMarks[colOf[x]] = f->dist[x] % 10;}
+        }
+        fwrite(rowMarks,sizeof(signed char),cols,marks);
+
+        /* Drop the rows above again before moving up. Some saved edges join
+           two cells of this row, so the edges go first, then the nodes. */
+        for (int e = 0; e < numEdges; ++e)
+            removeEdge(f,map[edges[3*e]],map[edges[3*e+1]]);
+        for (int e = 0; e < numEdges; ++e)
+            for (int side = 0; side < 2; ++side)
+            {
+                int x = map[edges[3*e+side]];
+                if (x != -1 && (f->flags[x] & PREFIX)) {freeNode(f,x);}
+                map[edges[3*e+side]] = -1;
+            }
+        for (int i = 0; i < 2; ++i)
+        {
+            int y = i == 0 ? sPrefix : gPrefix;
+            if (y == -1 || map[y] == -1) {continue;}
+            if (f->flags[map[y]] & PREFIX) {freeNode(f,map[y]);}
+            map[y] = -1;
+        }
+        for (int c = 0; c < cols; ++c)
+            map[prefixTerm[c]] = -1;
+        free(edges);
+        compress(f);
+
+        int *swapTerm = prevTerm; prevTerm = term; term = swapTerm;
+    }
+
+    free(rowMarks);
+    free(colOf);
+    free(map);
+    free(prefixTerm);
+    free(prevTerm);
+    free(term);
+    freeROW(cur);
+    freeFOREST(f);
+    return length;
+}
+
+/* Copies the maze to out, taking each row's values from the marks, which
+   were written bottom row first. */
+static void emitSolution(FILE *rowFile,FILE *marks,FILE *out,
+                         long start,long goal)
+{
+    int rows = 0, cols = 0;
+    rewind(rowFile);
+    fscanf(rowFile,"%d %d",&rows,&cols);
+    ROW *r = newROW(cols);
+    signed char *rowMarks = malloc(sizeof(signed char) * cols);
+    assert(rowMarks != 0);
+
+    fprintf(out,"%d %d\n",rows,cols);
+    for (int k = 0; k < rows; ++k)
+    {
+        readROW(rowFile,r,cols,k < rows - 1);
+        fseek(marks,(long)(rows - 1 - k) * cols,SEEK_SET);
+        fread(rowMarks,sizeof(signed char),cols,marks);
+        for (int c = 0; c < cols; ++c)
+            r->values[c] = rowMarks[c];
+        writeROW(out,r,cols,k < rows - 1);
+    }
+    if (start != 0 || goal != (long)rows * cols - 1)
+        fprintf(out,"ends %ld %ld %ld %ld\n",start / cols,start % cols,
+            goal / cols,goal % cols);
+
+    free(rowMarks);
+    freeROW(r);
+}
+
+/* Saves the forest with the file offset of its row. The record ends with
+   its own size so the records can be read back from last to first. */
+static void writeRecord(FILE *fp,long offset,int sNode,int gNode,int *term,
+                        FOREST *f,int cols)
+{
+    int numEdges = 0;
+    for (int x = 0; x < f->cap; ++x)
+        for (int i = 0; i < f->deg[x]; ++i)
+            if (x < f->adj[4*x+i]) {++numEdges;}
+
+    fwrite(&offset,sizeof(long),1,fp);
+    fwrite(&sNode,sizeof(int),1,fp);
+    fwrite(&gNode,sizeof(int),1,fp);
+    fwrite(term,sizeof(int),cols,fp);
+    fwrite(&numEdges,sizeof(int),1,fp);
+    for (int x = 0; x < f->cap; ++x)
+        for (int i = 0; i < f->deg[x]; ++i)
+            if (x < f->adj[4*x+i])
+            {
+                int edge[3] = {x,f->adj[4*x+i],f->weight[4*x+i]};
+                fwrite(edge,sizeof(int),3,fp);
+            }
+
+    long size = sizeof(long) + sizeof(int) * (cols + 3 + 3 * numEdges);
+    fwrite(&size,sizeof(long),1,fp);
+}
+
+/* Reads the record that ends at end and returns where it starts. */
+static long readRecord(FILE *fp,long end,long *offset,int *sNode,int *gNode,
+                       int *term,int **edges,int *numEdges,int cols)
+{
+    long size;
+    fseek(fp,end - (long)sizeof(long),SEEK_SET);
+    fread(&size,sizeof(long),1,fp);
+
+    long start = end - (long)sizeof(long) - size;
+    fseek(fp,start,SEEK_SET);
+    fread(offset,sizeof(long),1,fp);
+    fread(sNode,sizeof(int),1,fp);
+    fread(gNode,sizeof(int),1,fp);
+    fread(term,sizeof(int),cols,fp);
+    fread(numEdges,sizeof(int),1,fp);
+    *edges = malloc(sizeof(int) * (3 * *numEdges + 1));
+    assert(*edges != 0);
+    fread(*edges,sizeof(int),3 * *numEdges,fp);
+    return start;
+}
+
+static FOREST *newFOREST(int cap)
+{
+    FOREST *f = malloc(sizeof(FOREST));
+    assert(f != 0);
+
+    f->cap = cap;
+    f->adj = malloc(sizeof(int) * 4 * cap);
+    f->weight = malloc(sizeof(int) * 4 * cap);
+    f->deg = calloc(cap,sizeof(int));
+    f->flags = calloc(cap,sizeof(unsigned char));
+    f->freeList = malloc(sizeof(int) * cap);
+    f->work = malloc(sizeof(int) * 2 * cap);
+    f->parent = malloc(sizeof(int) * cap);
+    f->dist = malloc(sizeof(long) * cap);
+    assert(f->adj && f->weight && f->deg && f->flags && f->freeList);
+    assert(f->work && f->parent && f->dist);
+
+    /* Hand out low node numbers first. */
+    f->freeCount = cap;
+    for (int i = 0; i < cap; ++i)
+        f->freeList[i] = cap - 1 - i;
+
+    return f;
+}
+
+static int addNode(FOREST *f,int flags)
+{
+    assert(f->freeCount > 0);
+    int x = f->freeList[--f->freeCount];
+    f->deg[x] = 0;
+    f->flags[x] = ALIVE | flags;
+    return x;
+}
+
+static void freeNode(FOREST *f,int x)
+{
+    assert(f->deg[x] == 0);
+    f->flags[x] = 0;
+    f->freeList[f->freeCount++] = x;
+}
+
+static void addEdge(FOREST *f,int u,int v,int w)
+{
+    assert(f->deg[u] < 4 && f->deg[v] < 4);
+    f->adj[4*u+f->deg[u]] = v;
+    f->weight[4*u+f->deg[u]++] = w;
+    f->adj[4*v+f->deg[v]] = u;
+    f->weight[4*v+f->deg[v]++] = w;
+}
+
+static void removeEdge(FOREST *f,int u,int v)
+{
+    for (int side = 0; side < 2; ++side)
+    {
+        for (int i = 0; i < f->deg[u]; ++i)
+            if (f->adj[4*u+i] == v)
+            {
+                int last = 4*u + --f->deg[u];
+                f->adj[4*u+i] = f->adj[last];
+                f->weight[4*u+i] = f->weight[last];
+                break;
+            }
+        int swap = u; u = v; v = swap;
+    }
+}
+
+/* Removes every node that is not a terminal, the start, or the goal and is
+   not needed to keep the distances between those that are. */
+static void compress(FOREST *f)
+{
+    int count = 0;
+    for (int x = 0; x < f->cap; ++x)
+        if (f->flags[x] & ALIVE) {f->work[count++] = x;}
+
+    while (count)
+    {
+        int x = f->work[--count];
+        if (!(f->flags[x] & ALIVE)) {continue;}
+        if (f->flags[x] & (TERMINAL | START | GOAL)) {continue;}
+
+        if (f->deg[x] == 0) {freeNode(f,x);}
+        else if (f->deg[x] == 1)
+        {
+            int y = f->adj[4*x];
+            removeEdge(f,x,y);
+            freeNode(f,x);
+            f->work[count++] = y;
+        }
+        else if (f->deg[x] == 2)
+        {
+            int a = f->adj[4*x], b = f->adj[4*x+1];
+            int w = f->weight[4*x] + f->weight[4*x+1];
+            removeEdge(f,x,a);
+            removeEdge(f,x,b);
+            freeNode(f,x);
+            addEdge(f,a,b,w);
+        }
+    }
+}
+
+/* Puts the nodes of each tree of the forest into one set so new edges can
+   be checked for loops. */
+static void initSets(FOREST *f)
+{
+    for (int x = 0; x < f->cap; ++x)
+        f->parent[x] = x;
+    for (int x = 0; x < f->cap; ++x)
+        for (int i = 0; i < f->deg[x]; ++i)
+            joinSets(f,x,f->adj[4*x+i]);
+}
+
+static int findSet(FOREST *f,int x)
+{
+    while (f->parent[x] != x)
+    {
+        f->parent[x] = f->parent[f->parent[x]];
+        x = f->parent[x];
+    }
+    return x;
+}
+
+/* Joins the sets of u and v. Returns 0 if they were already the same set,
+   meaning an edge from u to v would close a loop. */
+static int joinSets(FOREST *f,int u,int v)
+{
+    u = findSet(f,u);
+    v = findSet(f,v);
+    if (u == v) {return 0;}
+    f->parent[u] = v;
+    return 1;
+}
+
+/* Finds the distance from source to every node, or -1 if it is in another
+   tree, along with each node's parent on the way back to source. */
+static void searchFrom(FOREST *f,int source)
+{
+    for (int x = 0; x < f->cap; ++x)
+    {
+        f->dist[x] = -1;
+        f->parent[x] = -1;
+    }
+
+    int count = 0;
+    f->dist[source] = 0;
+    f->work[count++] = source;
+    while (count)
+    {
+        int x = f->work[--count];
+        for (int i = 0; i < f->deg[x]; ++i)
+        {
+            int y = f->adj[4*x+i];
+            if (f->dist[y] >= 0) {continue;}
+            f->dist[y] = f->dist[x] + f->weight[4*x+i];
+            f->parent[y] = x;
+            f->work[count++] = y;
+        }
+    }
+}
+
+static void freeFOREST(FOREST *f)
+{
+    free(f->dist);
+    free(f->parent);
+    free(f->work);
+    free(f->freeList);
+    free(f->flags);
+    free(f->deg);
+    free(f->weight);
+    free(f->adj);
+    free(f);
+}
+
+static ROW *newROW(int cols)
+{
+    ROW *r = malloc(sizeof(ROW));
+    assert(r != 0);
+    r->left = malloc(sizeof(int) * cols);
+    r->values = malloc(sizeof(int) * cols);
+    r->bottom = malloc(sizeof(int) * cols);
+    assert(r->left && r->values && r->bottom);
+    return r;
+}
+
+/* Reads one row of the maze file format and, unless it is the last row, the
+   line of bottom walls after it. Returns 0 if the file ends early. */
+static int readROW(FILE *fp,ROW *r,int cols,int hasBottom)
+{
+    for (int c = 0; c < cols; ++c)
+        if (fscanf(fp,"%d %d",&r->left[c],&r->values[c]) != 2) {return 0;}
+    if (fscanf(fp,"%d",&r->right) != 1) {return 0;}
+    if (hasBottom)
+        for (int c = 0; c < cols; ++c)
+            if (fscanf(fp,"%d",&r->bottom[c]) != 1) {return 0;}
+    return 1;
+}
+
+static void writeROW(FILE *fp,ROW *r,int cols,int hasBottom)
+{
+    for (int c = 0; c < cols; ++c)
+        fprintf(fp,"%d %d ",r->left[c],r->values[c]);
+    fprintf(fp,"%d\n",r->right);
+
+    if (hasBottom)
+    {
+        for (int c = 0; c < cols; ++c)
+        {
+            fprintf(fp,"%d",r->bottom[c]);
+            if (c < cols - 1) {fprintf(fp," ");}
+        }
+        fprintf(fp,"\n");
+    }
+}
+
+static void freeROW(ROW *r)
+{
+    free(r->bottom);
+    free(r->values);
+    free(r->left);
+    free(r);
+}
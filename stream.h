@@ -0,0 +1,9 @@
+#ifndef __STREAM_INCLUDED__
+#define __STREAM_INCLUDED__
+
+#include <stdio.h>
+
+extern long streamLENGTH(FILE *readFile);
+extern long streamSOLVE(FILE *readFile,FILE *writeFile);
+
+#endif
@@ -0,0 +1,211 @@
+/***************************************************************************
+ * This module draws a maze as an SVG file, which scales to any size for   *
+ * printing or the web. Drawing each wall as its own line makes files of a *
+ * large maze huge, so walls that continue one another are merged into one *
+ * segment: a run of top walls along a row is one horizontal segment, and  *
+ * a run of left walls down a column is one vertical segment. All the      *
+ * segments go in a single path element, and each is written as a move     *
+ * relative to the end of the one before it, so that the numbers in the    *
+ * file stay short:                                                        *
+ *                                                                         *
+ *   <path d="M0 0h5m1 0h4 ... m-3 2v6 ..."/>                              *
+ *                                                                         *
+ * Coordinates are in cells, and the image is scaled to the given number   *
+ * of pixels per cell. The path from the entrance to the exit, if asked    *
+ * for, is found with routeGRID and drawn as one polyline through the      *
+ * middles of its cells, with a point only where the path turns.           *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "svg.h"
+#include "grid.h"
+#include "route.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define BUFFER_BYTES 65536
+
+static const int RowStep[4] = {-1,0,0,1};
+static const int ColStep[4] = {0,-1,1,0};
+
+/* Output is gathered here since fprintf is far too slow for millions of
+   small numbers. */
+typedef struct out
+{
+    FILE *fp;
+    char buffer[BUFFER_BYTES];
+    int length;
+    /* The end of the last segment, where the next relative move starts. */
+    long x, y;
+} OUT;
+
+static void putSegment(OUT *o,long x,long y,char dir,long length);
+static void putText(OUT *o,const char *text);
+static void putNumber(OUT *o,long n);
+static void flushOut(OUT *o);
+static void drawPath(GRID *g,OUT *o);
+
+/* Draws the maze in readFile as SVG with each cell pixels wide, with its
+   path if path is set. Returns the number of wall segments drawn, or -1
+   if the file isn't a maze. */
+long svgMAZE(FILE *readFile,FILE *writeFile,int pixels,int path)
+{
+    GRID *g = readGRID(readFile);
+    if (g == 0) {return -1;}
+    int rows = getGRIDrows(g), cols = getGRIDcols(g);
+
+    OUT *o = malloc(sizeof(OUT));
+    /* Row where the wall run down each vertical line began, or -1. */
+    int *runStart = malloc(sizeof(int) * (cols + 1));
+    assert(o != 0 && runStart != 0);
+    o->fp = writeFile;
+    o->length = 0;
+    o->x = o->y = -1;
+    for (int x = 0; x <= cols; ++x) {runStart[x] = -1;}
+
+    fprintf(writeFile,"<svg xmlns=\"http://www.w3.org/2000/svg\" "
+        "width=\"%ld\" height=\"%ld\" viewBox=\"-0.5 -0.5 %d %d\">\n",
+        (long)cols * pixels + 1,(long)rows * pixels + 1,cols + 1,rows + 1);
+    fprintf(writeFile,"<rect x=\"-0.5\" y=\"-0.5\" width=\"%d\" "
+        "height=\"%d\" fill=\"white\"/>\n",cols + 1,rows + 1);
+    putText(o,"<path fill=\"none\" stroke=\"black\" stroke-width=\"0.1\" "
+        "stroke-linecap=\"square\" d=\"");
+
+    /* Horizontal line y is the top of row y, or the bottom of the last
+       row; vertical line x is the left of column x, or the right of the
+       last column. */
+    long segments = 0;
+    for (int y = 0; y <= rows; ++y)
+    {
+        int row = y < rows ? y : rows - 1, bit = y < rows ? 0x1 : 0x8;
+        for (int x = 0; x < cols; )
+        {
+            if (!(getGRIDwalls(g,row,x) & bit)) {++x; continue;}
+            int start = x;
+            while (x < cols && getGRIDwalls(g,row,x) & bit) {++x;}
+            putSegment(o,start,y,'h',x - start);
+            ++segments;
+        }
+        for (int x = 0; x <= cols && y < rows; ++x)
+        {
+            int wall = x < cols ? getGRIDwalls(g,y,x) & 0x2
+                : getGRIDwalls(g,y,cols-1) & 0x4;
+            if (wall && runStart[x] == -1) {runStart[x] = y;}
+            if (wall || runStart[x] == -1) {continue;}
+            putSegment(o,x,runStart[x],'v',y - runStart[x]);
+            runStart[x] = -1;
+            ++segments;
+        }
+    }
+    for (int x = 0; x <= cols; ++x)
+    {
+        if (runStart[x] == -1) {continue;}
+        putSegment(o,x,runStart[x],'v',rows - runStart[x]);
+        ++segments;
+    }
+    putText(o,"\"/>\n");
+
+    if (path) {drawPath(g,o);}
+    putText(o,"</svg>\n");
+    flushOut(o);
+
+    free(runStart);
+    free(o);
+    freeGRID(g);
+    return segments;
+}
+
+/* Draws the path as a polyline through the middles of its cells, shifted
+   half a cell so the points stay whole numbers. Draws nothing if the exit
+   can't be reached. */
+static void drawPath(GRID *g,OUT *o)
+{
+    int cols = getGRIDcols(g);
+    unsigned char *moves = malloc((long)getGRIDrows(g) * cols);
+    assert(moves != 0);
+    long length = routeGRID(g,moves);
+    if (length >= 0)
+    {
+        long start = getGRIDstart(g);
+        long row = start / cols, col = start % cols;
+        putText(o,"<polyline fill=\"none\" stroke=\"red\" "
+            "stroke-width=\"0.3\" stroke-linejoin=\"round\" "
+            "transform=\"translate(0.5 0.5)\" points=\"");
+        putNumber(o,col);
+        putText(o,",");
+        putNumber(o,row);
+        for (long k = 0; k < length; ++k)
+        {
+            row += RowStep[moves[k]];
+            col += ColStep[moves[k]];
+            if (k < length - 1 && moves[k+1] == moves[k]) {continue;}
+            putText(o," ");
+            putNumber(o,col);
+            putText(o,",");
+            putNumber(o,row);
+        }
+        putText(o,"\"/>\n");
+    }
+    free(moves);
+}
+
+/* Adds a horizontal ('h') or vertical ('v') segment of the given length
+   starting at x, y. */
+static void putSegment(OUT *o,long x,long y,char dir,long length)
+{
+    long dx = x, dy = y;
+    if (o->x == -1) {putText(o,"M");}
+    else
+    {
+        dx -= o->x;
+        dy -= o->y;
+        putText(o,"m");
+    }
+    putNumber(o,dx);
+    if (dy >= 0) {putText(o," ");}
+    putNumber(o,dy);
+    o->buffer[o->length++] = dir;
+    putNumber(o,length);
+
+    o->x = dir == 'h' ? x + length : x;
+    o->y = dir == 'v' ? y + length : y;
+}
+
+static void putText(OUT *o,const char *text)
+{
+    int length = strlen(text);
+    if (o->length + length > BUFFER_BYTES) {flushOut(o);}
+    if (length > BUFFER_BYTES)
+    {
+        fwrite(text,1,length,o->fp);
+        return;
+    }
+    memcpy(o->buffer + o->length,text,length);
+    o->length += length;
+}
+
+static void putNumber(OUT *o,long n)
+{
+    char digits[24];
+    int count = 0;
+    unsigned long u = n < 0 ? -(unsigned long)n : (unsigned long)n;
+    do
+    {
+        digits[count++] = '0' + u % 10;
+        u /= 10;
+    } while (u > 0);
+    if (n < 0) {digits[count++] = '-';}
+
+    /* Room for the number and a command letter after it. */
+    if (o->length + count + 1 > BUFFER_BYTES) {flushOut(o);}
+    while (count > 0) {o->buffer[o->length++] = digits[--count];}
+}
+
+static void flushOut(OUT *o)
+{
+    fwrite(o->buffer,1,o->length,o->fp);
+    o->length = 0;
+}
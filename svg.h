@@ -0,0 +1,8 @@
+#ifndef __SVG_INCLUDED__
+#define __SVG_INCLUDED__
+
+#include <stdio.h>
+
+extern long svgMAZE(FILE *readFile,FILE *writeFile,int pixels,int path);
+
+#endif
@@ -0,0 +1,356 @@
+/***************************************************************************
+ * This topology grid class holds mazes on grids other than the plain      *
+ * square one: a torus, whose edges wrap around to the opposite edge, and  *
+ * a hexagonal grid. A square grid is also available, for comparison.      *
+ *                                                                         *
+ * Everything a topology decides is precomputed into tables when the grid  *
+ * is made, so generation and solving are the same code for every kind of *
+ * grid and have no topology or edge tests in their inner loops. The cell *
+ * through side s of the cell at row r and column c is                     *
+ *                                                                         *
+ *     cell + rowDelta[s][r] + colDelta[s][r%2][c]                         *
+ *                                                                         *
+ * and that neighbor exists when bit s is set in rowMask[r] and in         *
+ * colMask[r%2][c]. The tables take space in proportion to the rows plus  *
+ * the columns. The row parity is there for the hexagonal grid, whose odd  *
+ * rows are shifted half a cell to the right.                              *
+ *                                                                         *
+ * Square and torus cells have sides 0 top, 1 left, 2 right, and 3 bottom, *
+ * like the grid class. Hexagonal cells have sides 0 upper left, 1 upper   *
+ * right, 2 left, 3 right, 4 lower left, and 5 lower right. On both, the   *
+ * opposite of side s is sides-1-s.                                        *
+ *                                                                         *
+ * Mazes are written as the line "KIND rows cols", KIND being square,      *
+ * torus, or hex, and then one line per row of each cell's walls as two   *
+ * hex digits, bit s set while side s is standing. The entrance is the     *
+ * first cell and the exit the last; neither is stored.                    *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "tgrid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Necissary for random() and srandom() to work.
+long int random(void);
+void srandom(unsigned int seed);
+
+#define MAXSIDES 6
+
+struct tgrid
+{
+    int kind;
+    int rows;
+    int cols;
+    int sides;
+    /* Bit s of a cell is set while side s of that cell is standing. */
+    unsigned char *cells;
+    unsigned char *rowMask;
+    unsigned char *colMask[2];
+    long *rowDelta[MAXSIDES];
+    int *colDelta[MAXSIDES][2];
+};
+
+static char *KindNames[3] = {"square","torus","hex"};
+
+/* Row and column steps through each side. Hexagonal columns depend on the
+   parity of the row. */
+static int SquareRow[4] = {-1,0,0,1};
+static int SquareCol[4] = {0,-1,1,0};
+static int HexRow[6] = {-1,-1,0,0,1,1};
+static int HexCol[2][6] = {{-1,0,-1,1,-1,0},{0,1,-1,1,0,1}};
+
+static void buildTables(TGRID *t);
+static void carve(TGRID *t,long *stack);
+static void search(TGRID *t,long *prev,long *queue);
+
+TGRID *newTGRID(int kind,int rows,int cols)
+{
+    assert(kind >= TGRID_SQUARE && kind <= TGRID_HEX);
+    assert(rows > 0 && cols > 0);
+
+    TGRID *t = (TGRID *)malloc(sizeof(TGRID));
+    assert(t != 0);
+
+    t->kind = kind;
+    t->rows = rows;
+    t->cols = cols;
+    t->sides = kind == TGRID_HEX ? 6 : 4;
+
+    long size = (long)rows * cols;
+    t->cells = malloc(sizeof(unsigned char) * size);
+    assert(t->cells != 0);
+    memset(t->cells,(1 << t->sides) - 1,size);
+
+    buildTables(t);
+    return t;
+}
+
+TGRID *generateTGRID(int kind,int rows,int cols,int randSeed)
+{
+    srandom(randSeed);
+    TGRID *t = newTGRID(kind,rows,cols);
+
+    long *stack = malloc(sizeof(long) * rows * cols);
+    assert(stack != 0);
+    carve(t,stack);
+    free(stack);
+
+    return t;
+}
+
+int getTGRIDkind(TGRID *t) {return t->kind;}
+int getTGRIDrows(TGRID *t) {return t->rows;}
+int getTGRIDcols(TGRID *t) {return t->cols;}
+int getTGRIDsides(TGRID *t) {return t->sides;}
+int getTGRIDwalls(TGRID *t,long cell) {return t->cells[cell];}
+
+/* Returns the cell through the given side, or -1 if there is none. */
+long neighborTGRID(TGRID *t,long cell,int side)
+{
+    assert(side >= 0 && side < t->sides);
+    int row = cell / t->cols;
+    int col = cell - (long)row * t->cols;
+    int parity = row & 1;
+
+    if (!(t->rowMask[row] & t->colMask[parity][col] & (1 << side)))
+        return -1;
+    return cell + t->rowDelta[side][row] + t->colDelta[side][parity][col];
+}
+
+/* Fills path with the cells from the first cell to the last and returns
+   how many there are, or returns -1 if the last can't be reached. */
+long pathTGRID(TGRID *t,long *path)
+{
+    long size = (long)t->rows * t->cols;
+    long *prev = malloc(sizeof(long) * size);
+    long *queue = malloc(sizeof(long) * size);
+    assert(prev != 0 && queue != 0);
+    search(t,prev,queue);
+
+    long count = -1;
+    long cell = size - 1;
+    if (prev[cell] != -1)
+    {
+        /* Walk back to the entrance, then reverse. */
+        count = 0;
+        path[count++] = cell;
+        while (cell != 0)
+        {
+            cell = prev[cell];
+            path[count++] = cell;
+        }
+        for (long i = 0; i < count / 2; ++i)
+        {
+            long swap = path[i];
+            path[i] = path[count-1-i];
+            path[count-1-i] = swap;
+        }
+    }
+
+    free(prev);
+    free(queue);
+    return count;
+}
+
+void writeTGRID(TGRID *t,FILE *fp)
+{
+    fprintf(fp,"%s %d %d\n",KindNames[t->kind],t->rows,t->cols);
+    for (int i = 0; i < t->rows; ++i)
+        for (int j = 0; j < t->cols; ++j)
+            fprintf(fp,j < t->cols - 1 ? "%02x " : "%02x\n",
+                t->cells[(long)i * t->cols + j]);
+}
+
+/* Returns 0 if the file doesn't start with a topology grid. */
+TGRID *readTGRID(FILE *fp)
+{
+    char name[8];
+    int rows = 0, cols = 0;
+    if (fscanf(fp,"%7s %d %d",name,&rows,&cols) != 3) {return 0;}
+    int kind = kindTGRID(name);
+    if (kind < 0 || rows < 1 || cols < 1) {return 0;}
+
+    TGRID *t = newTGRID(kind,rows,cols);
+    unsigned int walls = 0;
+    for (long i = 0; i < (long)rows * cols; ++i)
+    {
+        if (fscanf(fp,"%x",&walls) != 1) {break;}
+        t->cells[i] = walls;
+    }
+    return t;
+}
+
+void freeTGRID(TGRID *t)
+{
+    free(t->cells);
+    free(t->rowMask);
+    for (int p = 0; p < 2; ++p) {free(t->colMask[p]);}
+    for (int s = 0; s < t->sides; ++s)
+    {
+        free(t->rowDelta[s]);
+        for (int p = 0; p < 2; ++p) {free(t->colDelta[s][p]);}
+    }
+    free(t);
+}
+
+/* Returns the topology with the given name, or -1. */
+int kindTGRID(char *name)
+{
+    for (int kind = TGRID_SQUARE; kind <= TGRID_HEX; ++kind)
+        if (strcmp(name,KindNames[kind]) == 0)
+            return kind;
+    return -1;
+}
+
+void createTGRID(int kind,int rows,int cols,int randSeed,FILE *fp)
+{
+    TGRID *t = generateTGRID(kind,rows,cols,randSeed);
+    writeTGRID(t,fp);
+    freeTGRID(t);
+}
+
+/* Writes the maze followed by "path N" and the row and column of the N
+   cells on the path. Returns the number of steps, or -1. */
+long solveTGRID(FILE *readFile,FILE *writeFile)
+{
+    TGRID *t = readTGRID(readFile);
+    if (t == 0) {return -1;}
+
+    long *path = malloc(sizeof(long) * t->rows * t->cols);
+    assert(path != 0);
+    long count = pathTGRID(t,path);
+
+    writeTGRID(t,writeFile);
+    fprintf(writeFile,"path %ld\n",count > 0 ? count : 0);
+    for (long i = 0; i < count; ++i)
+        fprintf(writeFile,"%ld %ld\n",path[i] / t->cols,path[i] % t->cols);
+
+    free(path);
+    freeTGRID(t);
+    return count > 0 ? count - 1 : -1;
+}
+
+/* Fills in the neighbor tables. On a torus every neighbor exists, and a
+   step off one edge lands on the opposite edge. */
+static void buildTables(TGRID *t)
+{
+    int wrap = t->kind == TGRID_TORUS;
+
+    t->rowMask = malloc(sizeof(unsigned char) * t->rows);
+    assert(t->rowMask != 0);
+    for (int p = 0; p < 2; ++p)
+    {
+        t->colMask[p] = malloc(sizeof(unsigned char) * t->cols);
+        assert(t->colMask[p] != 0);
+    }
+    memset(t->rowMask,0,t->rows);
+    for (int p = 0; p < 2; ++p) {memset(t->colMask[p],0,t->cols);}
+
+    for (int s = 0; s < t->sides; ++s)
+    {
+        int dr = t->kind == TGRID_HEX ? HexRow[s] : SquareRow[s];
+        t->rowDelta[s] = malloc(sizeof(long) * t->rows);
+        assert(t->rowDelta[s] != 0);
+        for (int r = 0; r < t->rows; ++r)
+        {
+            int to = r + dr;
+            if (wrap) {to = (to + t->rows) % t->rows;}
+            if (to >= 0 && to < t->rows) {t->rowMask[r] |= 1 << s;}
+            t->rowDelta[s][r] = (long)(to - r) * t->cols;
+        }
+
+        for (int p = 0; p < 2; ++p)
+        {
+            int dc = t->kind == TGRID_HEX ? HexCol[p][s] : SquareCol[s];
+            t->colDelta[s][p] = malloc(sizeof(int) * t->cols);
+            assert(t->colDelta[s][p] != 0);
+            for (int c = 0; c < t->cols; ++c)
+            {
+                int to = c + dc;
+                if (wrap) {to = (to + t->cols) % t->cols;}
+                if (to >= 0 && to < t->cols) {t->colMask[p][c] |= 1 << s;}
+                t->colDelta[s][p][c] = to - c;
+            }
+        }
+    }
+}
+
+/* Removes walls with a randomized depth first search from the first cell.
+   A cell not yet reached has all its sides standing, so no visited flags
+   are needed. A cell that is its own neighbor, on a torus one cell wide,
+   is never carved into. */
+static void carve(TGRID *t,long *stack)
+{
+    const int closed = (1 << t->sides) - 1;
+    long top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        long cell = stack[top-1];
+        int row = cell / t->cols;
+        int col = cell - (long)row * t->cols;
+        int parity = row & 1;
+        int exists = t->rowMask[row] & t->colMask[parity][col];
+
+        int choices[MAXSIDES];
+        int count = 0;
+        for (int s = 0; s < t->sides; ++s)
+        {
+            if (!(exists & (1 << s))) {continue;}
+            long next = cell + t->rowDelta[s][row]
+                             + t->colDelta[s][parity][col];
+            if (t->cells[next] == closed && next != cell)
+                choices[count++] = s;
+        }
+        if (count == 0) {--top; continue;}
+
+        int side = choices[random() % count];
+        long next = cell + t->rowDelta[side][row]
+                         + t->colDelta[side][parity][col];
+        t->cells[cell] &= ~(1 << side);
+        t->cells[next] &= ~(1 << (t->sides - 1 - side));
+        stack[top++] = next;
+    }
+}
+
+/* Sets prev of every cell reached from the first cell to the cell it was
+   reached from (the first cell is its own), stopping at the last cell. */
+static void search(TGRID *t,long *prev,long *queue)
+{
+    long size = (long)t->rows * t->cols;
+    long head = 0, tail = 0;
+    for (long i = 0; i < size; ++i) {prev[i] = -1;}
+    prev[0] = 0;
+    queue[tail++] = 0;
+
+    while (head < tail)
+    {
+        long cell = queue[head++];
+        if (cell == size - 1) {break;}
+        int row = cell / t->cols;
+        int col = cell - (long)row * t->cols;
+        int parity = row & 1;
+
+        /* A maze read from a file may open a side with no neighbor behind
+           it, so such sides are treated as standing. Every open side then
+           leads to a neighbor, and no edge test is needed per side. */
+        int walls = t->cells[cell]
+                  | ~(t->rowMask[row] & t->colMask[parity][col]);
+        for (int s = 0; s < t->sides; ++s)
+        {
+            if (walls & (1 << s)) {continue;}
+            long next = cell + t->rowDelta[s][row]
+                             + t->colDelta[s][parity][col];
+            if (prev[next] == -1)
+            {
+                prev[next] = cell;
+                queue[tail++] = next;
+            }
+        }
+    }
+}
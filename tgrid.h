@@ -0,0 +1,30 @@
+#ifndef __TGRID_INCLUDED__
+#define __TGRID_INCLUDED__
+
+#include <stdio.h>
+
+/* Topologies. */
+#define TGRID_SQUARE 0
+#define TGRID_TORUS  1
+#define TGRID_HEX    2
+
+typedef struct tgrid TGRID;
+
+extern TGRID *newTGRID(int kind,int rows,int cols);
+extern TGRID *generateTGRID(int kind,int rows,int cols,int randSeed);
+extern int    getTGRIDkind(TGRID *t);
+extern int    getTGRIDrows(TGRID *t);
+extern int    getTGRIDcols(TGRID *t);
+extern int    getTGRIDsides(TGRID *t);
+extern int    getTGRIDwalls(TGRID *t,long cell);
+extern long   neighborTGRID(TGRID *t,long cell,int side);
+extern long   pathTGRID(TGRID *t,long *path);
+extern void   writeTGRID(TGRID *t,FILE *fp);
+extern TGRID *readTGRID(FILE *fp);
+extern void   freeTGRID(TGRID *t);
+
+extern int  kindTGRID(char *name);
+extern void createTGRID(int kind,int rows,int cols,int randSeed,FILE *fp);
+extern long solveTGRID(FILE *readFile,FILE *writeFile);
+
+#endif
@@ -0,0 +1,654 @@
+/***************************************************************************
+ * This module checks that a maze file is well formed and holds a perfect  *
+ * maze: every wall is 0 or 1, the outer walls are standing except for the *
+ * entrance and exit (at the corners, or where an ends line puts them),    *
+ * the passages connect every cell, and there are no loops, so the         *
+ * passages form a spanning tree with one fewer passage than there are     *
+ * cells. All of the checks are made together in a single pass over the    *
+ * file, which is read through a large buffer with a hand written number   *
+ * parser, so the time is linear in the size of the file.                  *
+ *                                                                         *
+ * Memory is proportional to the number of columns, not cells, so files    *
+ * far larger than memory can be checked. Each row's passages are joined   *
+ * in a union-find holding the cells of the row and the components of the  *
+ * rows above, which are all that can still be joined. A passage between   *
+ * two cells already joined closes a loop, and a component of the rows     *
+ * above that no cell of the row joins can never reach the rest.           *
+ *                                                                         *
+ * Binary grids, archives, multi-level mazes, and topology mazes hold both *
+ * sides of every wall, so for them it is also checked that the two sides  *
+ * agree. They are read whole, as their readers do, and checked with a     *
+ * union-find over every cell. Packed mazes store only a parent for each   *
+ * cell, which their reader already checks form a spanning tree. Binary    *
+ * files are told apart by their four byte magic.                          *
+ *                                                                         *
+ * validateMAZE writes one line to the report saying what was found and    *
+ * returns 1 if the maze is valid and 0 if not.                            *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "valid.h"
+#include "grid.h"
+#include "nmaze.h"
+#include "tgrid.h"
+#include "smaze.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <assert.h>
+
+#define BUFFERSIZE (1 << 20)
+
+typedef struct reader
+{
+    FILE *fp;
+    unsigned char *buffer;
+    size_t size;
+    size_t pos;
+} READER;
+
+/* Where the first problem was found, for the report, and the openings in
+   the outer wall and the ends line, which are checked once all are read. */
+typedef struct check
+{
+    long row;
+    long col;
+    long passages;
+    int openings;
+    long openCell[2];
+    int openSide[2];    /* 1 for a left wall, 2 for a right wall */
+    int hasEnds;
+    long ends[4];
+} CHECK;
+
+static char *checkMAZE(READER *r,CHECK *c,long *rows,long *cols);
+static char *checkBLOCKS(READER *r,CHECK *c,long rows,long cols);
+static char *checkENDS(CHECK *c,long rows,long cols);
+static int   reportMAZE(char *problem,CHECK *c,long rows,long cols,
+                        FILE *report);
+static int   validateBINARY(FILE *fp,FILE *report);
+static int   validateGRID(GRID *g,FILE *report);
+static int   validateNMAZE(NMAZE *m,FILE *report);
+static int   validateTGRID(FILE *fp,FILE *report);
+static char *checkGraph(long cells,int sides,void *maze,
+                 int (*walls)(void *,long),
+                 long (*neighbor)(void *,long,int),
+                 int (*opposite)(void *,int),CHECK *c);
+static int   nmazeWalls(void *m,long cell);
+static long  nmazeNeighbor(void *m,long cell,int side);
+static int   nmazeOpposite(void *m,int side);
+static int   tgridWalls(void *t,long cell);
+static long  tgridNeighbor(void *t,long cell,int side);
+static int   tgridOpposite(void *t,int side);
+static int   gridWalls(void *g,long cell);
+static long  gridNeighbor(void *g,long cell,int side);
+static int   gridOpposite(void *g,int side);
+static int   peekChar(READER *r);
+static int   readLong(READER *r,long *value);
+static int   readWall(READER *r,int *wall);
+static int   readWord(READER *r,char *word,int max);
+static int   findSet(int *parent,int i);
+static int   joinSets(int *parent,unsigned char *rank,int a,int b);
+
+int validateMAZE(FILE *readFile,FILE *report)
+{
+    /* The classic format starts with a number; the others with a word or
+       the binary magic number. */
+    int first = getc(readFile);
+    while (first != EOF && isspace(first)) {first = getc(readFile);}
+    if (first == EOF)
+    {
+        fprintf(report,"empty file\n");
+        return 0;
+    }
+    ungetc(first,readFile);
+    if (first == 'M') {return validateBINARY(readFile,report);}
+    if (first == 'n') {return validateNMAZE(readNMAZE(readFile),report);}
+    if (isalpha(first)) {return validateTGRID(readFile,report);}
+
+    READER r;
+    r.fp = readFile;
+    r.buffer = malloc(BUFFERSIZE);
+    assert(r.buffer != 0);
+    r.size = 0;
+    r.pos = 0;
+
+    CHECK c = {-1,-1,0,0,{0,0},{0,0},0,{0,0,0,0}};
+    long rows = 0, cols = 0;
+    char *problem = checkMAZE(&r,&c,&rows,&cols);
+    if (problem == 0) {problem = checkBLOCKS(&r,&c,rows,cols);}
+    if (problem == 0) {problem = checkENDS(&c,rows,cols);}
+    free(r.buffer);
+    return reportMAZE(problem,&c,rows,cols,report);
+}
+
+/* Writes what was found in a maze of rows and columns and returns 1 if
+   there was no problem. */
+static int reportMAZE(char *problem,CHECK *c,long rows,long cols,
+                      FILE *report)
+{
+    if (problem == 0)
+    {
+        fprintf(report,"perfect maze, %ld x %ld, %ld passages\n",
+            rows,cols,c->passages);
+        return 1;
+    }
+    if (c->row < 0) {fprintf(report,"%s\n",problem);}
+    else if (c->col < 0) {fprintf(report,"row %ld: %s\n",c->row,problem);}
+    else {fprintf(report,"row %ld column %ld: %s\n",c->row,c->col,problem);}
+    return 0;
+}
+
+/* Checks the classic maze format, returning what is wrong or 0. */
+static char *checkMAZE(READER *r,CHECK *c,long *rows,long *cols)
+{
+    if (readLong(r,rows) != 1 || readLong(r,cols) != 1)
+        return "missing rows and columns";
+    if (*rows < 1 || *cols < 1 || *cols > INT_MAX / 2)
+        return "bad number of rows or columns";
+
+    /* Nodes 0 to cols-1 are the components of the rows above, and nodes
+       cols to 2*cols-1 the cells of the current row. */
+    int n = *cols;
+    int *parent = malloc(sizeof(int) * 2 * n);
+    unsigned char *rank = malloc(2 * n);
+    int *label = malloc(sizeof(int) * n);
+    int *relabel = malloc(sizeof(int) * 2 * n);
+    unsigned char *down = malloc(n);
+    assert(parent != 0 && rank != 0 && label != 0);
+    assert(relabel != 0 && down != 0);
+    for (int k = 0; k < 2 * n; ++k) {relabel[k] = -1;}
+
+    char *problem = 0;
+    int above = 0;
+    int wall = 0;
+    long value = 0;
+    for (long i = 0; i < *rows && problem == 0; ++i)
+    {
+        c->row = i;
+        for (int k = 0; k < above; ++k) {parent[k] = k; rank[k] = 0;}
+        for (int j = 0; j < n; ++j) {parent[n+j] = n + j; rank[n+j] = 0;}
+
+        for (int j = 0; j < n && problem == 0; ++j)
+        {
+            c->col = j;
+            if (!readWall(r,&wall)) {problem = "bad left wall"; break;}
+            if (readLong(r,&value) != 1) {problem = "bad value"; break;}
+            if (j == 0 && !wall)
+            {
+                if (c->openings == 2)
+                    problem = "too many openings in the outer wall";
+                else
+                {
+                    c->openCell[c->openings] = i * n;
+                    c->openSide[c->openings++] = 1;
+                }
+            }
+            else if (j > 0 && !wall)
+            {
+                ++c->passages;
+                if (!joinSets(parent,rank,n+j-1,n+j))
+                    problem = "passage closes a loop";
+            }
+            if (problem == 0 && i > 0 && down[j])
+            {
+                ++c->passages;
+                if (!joinSets(parent,rank,n+j,label[j]))
+                    problem = "passage closes a loop";
+            }
+        }
+        if (problem) {break;}
+
+        c->col = n - 1;
+        if (!readWall(r,&wall)) {problem = "bad right wall"; break;}
+        if (!wall)
+        {
+            if (c->openings == 2)
+            {
+                problem = "too many openings in the outer wall";
+                break;
+            }
+            c->openCell[c->openings] = i * n + n - 1;
+            c->openSide[c->openings++] = 2;
+        }
+
+        if (i < *rows - 1)
+            for (int j = 0; j < n && problem == 0; ++j)
+            {
+                c->col = j;
+                if (!readWall(r,&wall)) {problem = "bad bottom wall";}
+                down[j] = !wall;
+            }
+        if (problem) {break;}
+
+        /* Every component above must go on into this row. */
+        c->col = -1;
+        for (int j = 0; j < n; ++j) {relabel[findSet(parent,n+j)] = 0;}
+        for (int k = 0; k < above; ++k)
+            if (relabel[findSet(parent,k)] == -1)
+                problem = "cells above are cut off from the rest";
+        for (int j = 0; j < n; ++j) {relabel[findSet(parent,n+j)] = -1;}
+
+        /* Number this row's components for the next row. */
+        above = 0;
+        for (int j = 0; j < n; ++j)
+        {
+            int root = findSet(parent,n+j);
+            if (relabel[root] == -1) {relabel[root] = above++;}
+            label[j] = relabel[root];
+        }
+        for (int j = 0; j < n; ++j) {relabel[findSet(parent,n+j)] = -1;}
+    }
+
+    if (problem == 0 && above != 1)
+    {
+        c->row = *rows - 1;
+        c->col = -1;
+        problem = "maze is not connected";
+    }
+
+    free(parent);
+    free(rank);
+    free(label);
+    free(relabel);
+    free(down);
+    if (problem == 0) {c->row = c->col = -1;}
+    return problem;
+}
+
+/* Checks the optional costs and ends lines after the maze, and that
+   nothing else follows them. */
+static char *checkBLOCKS(READER *r,CHECK *c,long rows,long cols)
+{
+    char word[8];
+    int found;
+    while ((found = readWord(r,word,sizeof(word))) != 0)
+    {
+        if (found > 0 && strcmp(word,"costs") == 0)
+        {
+            long cost = 0;
+            for (long i = 0; i < rows; ++i)
+                for (long j = 0; j < cols; ++j)
+                    if (readLong(r,&cost) != 1 || cost < 1 || cost > 255)
+                    {
+                        c->row = i;
+                        c->col = j;
+                        return "bad cost";
+                    }
+        }
+        else if (found > 0 && strcmp(word,"ends") == 0)
+        {
+            for (int k = 0; k < 4; ++k)
+                if (readLong(r,&c->ends[k]) != 1)
+                    return "bad ends";
+            if (c->ends[0] < 0 || c->ends[0] >= rows || c->ends[1] < 0
+                || c->ends[1] >= cols || c->ends[2] < 0 || c->ends[2] >= rows
+                || c->ends[3] < 0 || c->ends[3] >= cols)
+                return "ends are outside the maze";
+            c->hasEnds = 1;
+        }
+        else {return "unexpected data after the maze";}
+    }
+    return 0;
+}
+
+/* Without an ends line, the outer wall must be open on the left of the
+   first cell and the right of the last. With one, it may only be open at
+   the ends. */
+static char *checkENDS(CHECK *c,long rows,long cols)
+{
+    if (c->hasEnds)
+    {
+        long start = c->ends[0] * cols + c->ends[1];
+        long goal = c->ends[2] * cols + c->ends[3];
+        for (int k = 0; k < c->openings; ++k)
+            if (c->openCell[k] != start && c->openCell[k] != goal)
+            {
+                c->row = c->openCell[k] / cols;
+                c->col = c->openCell[k] % cols;
+                return "outer wall is open away from the ends";
+            }
+        return 0;
+    }
+
+    int entrance = 0, exit = 0;
+    for (int k = 0; k < c->openings; ++k)
+    {
+        if (c->openCell[k] == 0 && c->openSide[k] == 1) {entrance = 1;}
+        else if (c->openCell[k] == rows * cols - 1 && c->openSide[k] == 2)
+            exit = 1;
+        else
+        {
+            c->row = c->openCell[k] / cols;
+            c->col = c->openCell[k] % cols;
+            return c->openSide[k] == 1 ? "left edge is open"
+                                       : "right edge is open";
+        }
+    }
+    if (!entrance) {return "entrance is closed";}
+    if (!exit) {return "exit is closed";}
+    return 0;
+}
+
+/* Checks a binary file of whichever kind its magic names. */
+static int validateBINARY(FILE *fp,FILE *report)
+{
+    char magic[4];
+    if (fread(magic,1,4,fp) != 4)
+    {
+        fprintf(report,"bad binary header\n");
+        return 0;
+    }
+    if (memcmp(magic,"MZND",4) == 0)
+        return validateNMAZE(readNMAZEmagic(fp,magic),report);
+    if (memcmp(magic,"MZGD",4) == 0 || memcmp(magic,"MZAR",4) == 0)
+    {
+        GRID *g = readGRIDmagic(fp,magic);
+        if (g == 0)
+        {
+            fprintf(report,"bad binary maze header\n");
+            return 0;
+        }
+        return validateGRID(g,report);
+    }
+    if (memcmp(magic,"MZST",4) == 0)
+    {
+        /* readSMAZE already checks that the parent codes form a spanning
+           tree, which is all a packed maze can get wrong. */
+        SMAZE *m = readSMAZEmagic(fp,magic);
+        if (m == 0)
+        {
+            fprintf(report,"bad packed maze\n");
+            return 0;
+        }
+        long rows = getSMAZErows(m), cols = getSMAZEcols(m);
+        fprintf(report,"perfect maze, %ld x %ld, %ld passages\n",
+            rows,cols,rows * cols - 1);
+        freeSMAZE(m);
+        return 1;
+    }
+    fprintf(report,"unsupported format %.4s\n",magic);
+    return 0;
+}
+
+/* Checks a binary grid or an archive, which keep their outer walls as
+   well. Those are checked first, the way checkMAZE checks them, and then taken as standing so
+   that checkGraph sees a closed maze. Frees the grid. */
+static int validateGRID(GRID *g,FILE *report)
+{
+    long rows = getGRIDrows(g), cols = getGRIDcols(g);
+    CHECK c = {-1,-1,0,0,{0,0},{0,0},0,{0,0,0,0}};
+    char *problem = 0;
+    for (long i = 0; i < rows * cols && problem == 0; ++i)
+    {
+        int walls = getGRIDwalls(g,i / cols,i % cols);
+        for (int side = 0; side < 4 && problem == 0; ++side)
+        {
+            if (gridNeighbor(g,i,side) != -1 || walls & 1 << side) {continue;}
+            c.row = i / cols;
+            c.col = i % cols;
+            if (side == 0 || side == 3)
+                problem = "passage leads out of the maze";
+            else if (c.openings == 2)
+                problem = "too many openings in the outer wall";
+            else
+            {
+                c.openCell[c.openings] = i;
+                c.openSide[c.openings++] = side;
+            }
+        }
+    }
+
+    if (problem == 0)
+    {
+        problem = checkGraph(rows * cols,4,g,gridWalls,gridNeighbor,
+            gridOpposite,&c);
+        c.col = c.row < 0 ? -1 : c.row % cols;
+        c.row = c.row < 0 ? -1 : c.row / cols;
+    }
+    if (problem == 0)
+    {
+        long start = getGRIDstart(g), goal = getGRIDgoal(g);
+        c.hasEnds = start != 0 || goal != rows * cols - 1;
+        c.ends[0] = start / cols;
+        c.ends[1] = start % cols;
+        c.ends[2] = goal / cols;
+        c.ends[3] = goal % cols;
+        problem = checkENDS(&c,rows,cols);
+    }
+    freeGRID(g);
+    return reportMAZE(problem,&c,rows,cols,report);
+}
+
+/* Checks a multi-level maze, or reports a bad header if m is 0. Frees the
+   maze. */
+static int validateNMAZE(NMAZE *m,FILE *report)
+{
+    if (m == 0)
+    {
+        fprintf(report,"bad multi-level maze header\n");
+        return 0;
+    }
+
+    CHECK c = {-1,-1,0,0,{0,0},{0,0},0,{0,0,0,0}};
+    char *problem = checkGraph(sizeNMAZE(m),2 * getNMAZEdims(m),m,
+        nmazeWalls,nmazeNeighbor,nmazeOpposite,&c);
+    if (problem == 0)
+        fprintf(report,"perfect %d dimensional maze, %ld cells, %ld "
+            "passages\n",getNMAZEdims(m),sizeNMAZE(m),c.passages);
+    else
+        fprintf(report,"cell %ld: %s\n",c.row,problem);
+
+    freeNMAZE(m);
+    return problem == 0;
+}
+
+static int validateTGRID(FILE *fp,FILE *report)
+{
+    TGRID *t = readTGRID(fp);
+    if (t == 0)
+    {
+        fprintf(report,"bad maze header\n");
+        return 0;
+    }
+
+    CHECK c = {-1,-1,0,0,{0,0},{0,0},0,{0,0,0,0}};
+    long cells = (long)getTGRIDrows(t) * getTGRIDcols(t);
+    char *problem = checkGraph(cells,getTGRIDsides(t),t,
+        tgridWalls,tgridNeighbor,tgridOpposite,&c);
+    if (problem == 0)
+        fprintf(report,"perfect maze, %d x %d, %ld passages\n",
+            getTGRIDrows(t),getTGRIDcols(t),c.passages);
+    else
+        fprintf(report,"row %ld column %ld: %s\n",c.row / getTGRIDcols(t),
+            c.row % getTGRIDcols(t),problem);
+
+    freeTGRID(t);
+    return problem == 0;
+}
+
+/* Checks a maze that stores both sides of every wall. Each passage is
+   joined from the side numbered lower of the two, so it is counted once.
+   The cell of the first problem is left in c->row. */
+static char *checkGraph(long cells,int sides,void *maze,
+    int (*walls)(void *,long),
+    long (*neighbor)(void *,long,int),
+    int (*opposite)(void *,int),CHECK *c)
+{
+    if (cells > INT_MAX) {return "maze is too large to check";}
+    int *parent = malloc(sizeof(int) * cells);
+    unsigned char *rank = calloc(cells,1);
+    assert(parent != 0 && rank != 0);
+    for (long i = 0; i < cells; ++i) {parent[i] = i;}
+
+    char *problem = 0;
+    for (long i = 0; i < cells && problem == 0; ++i)
+    {
+        c->row = i;
+        int mine = walls(maze,i);
+        for (int s = 0; s < sides && problem == 0; ++s)
+        {
+            int standing = (mine >> s) & 1;
+            long next = neighbor(maze,i,s);
+            if (next == -1)
+            {
+                if (!standing) {problem = "passage leads out of the maze";}
+                continue;
+            }
+            int back = opposite(maze,s);
+            if (((walls(maze,next) >> back) & 1) != standing)
+                problem = "walls disagree with the neighbor";
+            else if (!standing && s < back)
+            {
+                ++c->passages;
+                if (!joinSets(parent,rank,i,next))
+                    problem = "passage closes a loop";
+            }
+        }
+    }
+
+    if (problem == 0)
+    {
+        c->row = -1;
+        for (long i = 0; i < cells && problem == 0; ++i)
+            if (findSet(parent,i) != findSet(parent,0))
+            {
+                c->row = i;
+                problem = "maze is not connected";
+            }
+    }
+
+    free(parent);
+    free(rank);
+    return problem;
+}
+
+static int  nmazeWalls(void *m,long cell) {return getNMAZEwalls(m,cell);}
+static long nmazeNeighbor(void *m,long cell,int side)
+    {return neighborNMAZE(m,cell,side);}
+static int  nmazeOpposite(void *m,int side) {(void)m; return side ^ 1;}
+static int  tgridWalls(void *t,long cell) {return getTGRIDwalls(t,cell);}
+static long tgridNeighbor(void *t,long cell,int side)
+    {return neighborTGRID(t,cell,side);}
+static int  tgridOpposite(void *t,int side)
+    {return getTGRIDsides(t) - 1 - side;}
+
+/* The outer walls of a grid, already checked, count as standing. */
+static int  gridWalls(void *g,long cell)
+{
+    int cols = getGRIDcols(g), row = cell / cols, col = cell % cols;
+    int walls = getGRIDwalls(g,row,col);
+    if (row == 0) {walls |= 0x1;}
+    if (col == 0) {walls |= 0x2;}
+    if (col == cols - 1) {walls |= 0x4;}
+    if (row == getGRIDrows(g) - 1) {walls |= 0x8;}
+    return walls;
+}
+static long gridNeighbor(void *g,long cell,int side)
+{
+    static const int RowStep[4] = {-1,0,0,1};
+    static const int ColStep[4] = {0,-1,1,0};
+    int cols = getGRIDcols(g);
+    long row = cell / cols + RowStep[side], col = cell % cols + ColStep[side];
+    if (row < 0 || row >= getGRIDrows(g) || col < 0 || col >= cols)
+        return -1;
+    return row * cols + col;
+}
+static int  gridOpposite(void *g,int side) {(void)g; return 3 - side;}
+
+/* Returns the next character without reading past it, refilling the
+   buffer as needed. */
+static int peekChar(READER *r)
+{
+    if (r->pos == r->size)
+    {
+        r->size = fread(r->buffer,1,BUFFERSIZE,r->fp);
+        r->pos = 0;
+        if (r->size == 0) {return EOF;}
+    }
+    return r->buffer[r->pos];
+}
+
+/* Reads an integer. Returns 1, 0 at the end of the file, or -1 if the next
+   word isn't an integer. */
+static int readLong(READER *r,long *value)
+{
+    int ch;
+    while ((ch = peekChar(r)) != EOF && isspace(ch)) {++r->pos;}
+    if (ch == EOF) {return 0;}
+
+    int negative = 0;
+    if (ch == '-')
+    {
+        negative = 1;
+        ++r->pos;
+        ch = peekChar(r);
+    }
+    if (ch == EOF || !isdigit(ch)) {return -1;}
+
+    long v = 0;
+    while ((ch = peekChar(r)) != EOF && isdigit(ch))
+    {
+        if (v > (LONG_MAX - 9) / 10) {return -1;}
+        v = v * 10 + (ch - '0');
+        ++r->pos;
+    }
+    if (ch != EOF && !isspace(ch)) {return -1;}
+
+    *value = negative ? -v : v;
+    return 1;
+}
+
+/* Reads a wall, which must be 0 or 1. Returns 1 if it was. */
+static int readWall(READER *r,int *wall)
+{
+    long value = 0;
+    if (readLong(r,&value) != 1 || (value != 0 && value != 1)) {return 0;}
+    *wall = value;
+    return 1;
+}
+
+/* Reads a word of at most max-1 characters. Returns 1, 0 at the end of the
+   file, or -1 if the word is too long. */
+static int readWord(READER *r,char *word,int max)
+{
+    int ch;
+    while ((ch = peekChar(r)) != EOF && isspace(ch)) {++r->pos;}
+    if (ch == EOF) {return 0;}
+
+    int length = 0;
+    while ((ch = peekChar(r)) != EOF && !isspace(ch))
+    {
+        if (length == max - 1) {return -1;}
+        word[length++] = ch;
+        ++r->pos;
+    }
+    word[length] = '\0';
+    return 1;
+}
+
+/* Union-find with path halving and union by rank. */
+static int findSet(int *parent,int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/* Returns 0 if a and b were already in the same set. */
+static int joinSets(int *parent,unsigned char *rank,int a,int b)
+{
+    a = findSet(parent,a);
+    b = findSet(parent,b);
+    if (a == b) {return 0;}
+    if (rank[a] < rank[b]) {int swap = a; a = b; b = swap;}
+    parent[b] = a;
+    if (rank[a] == rank[b]) {++rank[a];}
+    return 1;
+}
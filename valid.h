@@ -0,0 +1,8 @@
+#ifndef __VALID_INCLUDED__
+#define __VALID_INCLUDED__
+
+#include <stdio.h>
+
+extern int validateMAZE(FILE *readFile,FILE *report);
+
+#endif
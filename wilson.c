@@ -0,0 +1,192 @@
+/***************************************************************************
+ * This module generates mazes with Wilson's algorithm, which picks every  *
+ * possible perfect maze of a given size with equal probability. Starting  *
+ * from each cell not yet in the maze, a random walk is taken until it     *
+ * reaches the maze. The direction last taken out of each cell is stored   *
+ * in two bits, so walking over a loop simply overwrites it and following  *
+ * the stored directions from the start gives the loop-erased path, which  *
+ * is then carved. The hybrid generator first grows the maze with an       *
+ * Aldous-Broder random walk, which is fast while most cells are new,      *
+ * and switches to Wilson's walks once a third of the cells are carved.    *
+ * Both stay uniform.                                                      *
+ *                                                                         *
+ * Author: Alan Hencey                                                     *
+ **************************************************************************/
+
+#include "wilson.h"
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+
+// Necissary for random() and srandom() to work.
+long int random(void);
+void srandom(unsigned int seed);
+
+static GRID *generate(int rows,int cols,int randSeed,int hybrid);
+static void  aldousBroder(GRID *g,unsigned char *inMaze,int start,int goal);
+static void  loopErasedWalks(GRID *g,unsigned char *inMaze);
+static int   randomStep(int rows,int cols,int cell,int *dir);
+static int   getDIR(unsigned char *dirs,int cell);
+static void  setDIR(unsigned char *dirs,int cell,int dir);
+static int   isINMAZE(unsigned char *inMaze,int cell);
+static void  setINMAZE(unsigned char *inMaze,int cell);
+
+GRID *generateWILSON(int rows,int cols,int randSeed)
+{
+    return generate(rows,cols,randSeed,0);
+}
+
+GRID *generateHYBRID(int rows,int cols,int randSeed)
+{
+    return generate(rows,cols,randSeed,1);
+}
+
+void createWILSON(int rows,int cols,int randSeed,FILE *fp)
+{
+    GRID *g = generateWILSON(rows,cols,randSeed);
+    writeGRID(g,fp);
+    freeGRID(g);
+}
+
+void createHYBRID(int rows,int cols,int randSeed,FILE *fp)
+{
+    GRID *g = generateHYBRID(rows,cols,randSeed);
+    writeGRID(g,fp);
+    freeGRID(g);
+}
+
+static GRID *generate(int rows,int cols,int randSeed,int hybrid)
+{
+    assert(rows > 0 && cols > 0);
+    assert((long)rows * cols <= INT_MAX);
+
+    srandom(randSeed);
+    int size = rows * cols;
+    GRID *g = newGRID(rows,cols);
+
+    /* One bit per cell marks the cells already carved into the maze. */
+    unsigned char *inMaze = calloc(size / 8 + 1,sizeof(unsigned char));
+    assert(inMaze != 0);
+
+    int root = random() % size;
+    setINMAZE(inMaze,root);
+    if (hybrid) {aldousBroder(g,inMaze,root,size / 3);}
+    loopErasedWalks(g,inMaze);
+
+    free(inMaze);
+    removeGRIDwall(g,0,0,1);
+    removeGRIDwall(g,rows-1,cols-1,2);
+    return g;
+}
+
+/* Walks randomly from start, carving into every cell not seen before, until
+   goal cells are in the maze. */
+static void aldousBroder(GRID *g,unsigned char *inMaze,int start,int goal)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    int carved = 1;
+    int cell = start;
+    int dir;
+
+    while (carved < goal)
+    {
+        int next = randomStep(rows,cols,cell,&dir);
+        if (!isINMAZE(inMaze,next))
+        {
+            removeGRIDwall(g,cell / cols,cell % cols,dir);
+            setINMAZE(inMaze,next);
+            ++carved;
+        }
+        cell = next;
+    }
+}
+
+static void loopErasedWalks(GRID *g,unsigned char *inMaze)
+{
+    int rows = getGRIDrows(g);
+    int cols = getGRIDcols(g);
+    int size = rows * cols;
+
+    /* Direction taken out of each cell by the current walk, four cells to a
+       byte. Only cells on the walk are ever read back. */
+    unsigned char *dirs = calloc(size / 4 + 1,sizeof(unsigned char));
+    assert(dirs != 0);
+
+    for (int start = 0; start < size; ++start)
+    {
+        if (isINMAZE(inMaze,start)) {continue;}
+
+        /* Walk until the maze is hit, overwriting the exit direction of any
+           cell walked through twice. This erases the loop between visits. */
+        int cell = start;
+        int dir;
+        while (!isINMAZE(inMaze,cell))
+        {
+            int next = randomStep(rows,cols,cell,&dir);
+            setDIR(dirs,cell,dir);
+            cell = next;
+        }
+
+        /* Follow the surviving directions from the start and carve them. */
+        cell = start;
+        while (!isINMAZE(inMaze,cell))
+        {
+            dir = getDIR(dirs,cell);
+            removeGRIDwall(g,cell / cols,cell % cols,dir);
+            setINMAZE(inMaze,cell);
+            if (dir == 0)      {cell -= cols;}
+            else if (dir == 1) {cell -= 1;}
+            else if (dir == 2) {cell += 1;}
+            else               {cell += cols;}
+        }
+    }
+    free(dirs);
+}
+
+/* Picks a random neighbor of cell inside the grid, storing the wall that
+   separates them in dir. */
+static int randomStep(int rows,int cols,int cell,int *dir)
+{
+    int row = cell / cols;
+    int col = cell % cols;
+    int choices[4];
+    int count = 0;
+
+    if (row > 0)        {choices[count++] = 0;}
+    if (col > 0)        {choices[count++] = 1;}
+    if (col < cols - 1) {choices[count++] = 2;}
+    if (row < rows - 1) {choices[count++] = 3;}
+
+    /* A single cell maze is in the maze from the start and never walks. */
+    assert(count > 0);
+    *dir = choices[random() % count];
+
+    if (*dir == 0)      {return cell - cols;}
+    else if (*dir == 1) {return cell - 1;}
+    else if (*dir == 2) {return cell + 1;}
+    else                {return cell + cols;}
+}
+
+static int getDIR(unsigned char *dirs,int cell)
+{
+    return (dirs[cell / 4] >> ((cell % 4) * 2)) & 3;
+}
+
+static void setDIR(unsigned char *dirs,int cell,int dir)
+{
+    int shift = (cell % 4) * 2;
+    dirs[cell / 4] = (dirs[cell / 4] & ~(3 << shift)) | (dir << shift);
+}
+
+static int isINMAZE(unsigned char *inMaze,int cell)
+{
+    return (inMaze[cell / 8] >> (cell % 8)) & 1;
+}
+
+static void setINMAZE(unsigned char *inMaze,int cell)
+{
+    inMaze[cell / 8] |= 1 << (cell % 8);
+}
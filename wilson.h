@@ -0,0 +1,12 @@
+#ifndef __WILSON_INCLUDED__
+#define __WILSON_INCLUDED__
+
+#include <stdio.h>
+#include "grid.h"
+
+extern GRID *generateWILSON(int rows,int cols,int randSeed);
+extern GRID *generateHYBRID(int rows,int cols,int randSeed);
+extern void  createWILSON(int rows,int cols,int randSeed,FILE *fp);
+extern void  createHYBRID(int rows,int cols,int randSeed,FILE *fp);
+
+#endif